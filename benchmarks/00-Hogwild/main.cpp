@@ -0,0 +1,84 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include "enn.hpp"
+
+//Same topology as example 4 (chords recognition)
+const unsigned numberOfInputNeurons = 24;
+const unsigned numberOfHiddenNeurons = 32;
+const unsigned numberOfOutputNeurons = 16;
+const unsigned numberOfLearningPoints = 100000;
+const unsigned numberOfNotesPerChord = 4;
+
+//With a null learning rate the weights do not move, so train() stops after two cycles while doing exactly the same work per learning point
+const float learningRate = 0.f;
+
+void createNetwork(ENN::NeuralNetwork & nn)
+{
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+}
+
+//The learning set is made of random chords: the outputs tell which pitch classes (12 first neurons) and which quarters of the 2 octaves (4 last neurons) contain notes
+ENN::LearningSet createLearningSet()
+{
+	ENN::LearningSet set;
+	
+	for (unsigned i=0 ; i<numberOfLearningPoints ; i++)
+	{
+		ENN::LearningVector inputs(numberOfInputNeurons, -0.5f);
+		ENN::LearningVector outputs(numberOfOutputNeurons, -0.5f);
+		
+		for (unsigned n=0 ; n<numberOfNotesPerChord ; n++)
+		{
+			const unsigned note = rand() % numberOfInputNeurons;
+			inputs[note] = 0.5f;
+			outputs[note % 12] = 0.5f;
+			outputs[12 + note / 6] = 0.5f;
+		}
+		
+		set.push_back(std::make_pair(inputs, outputs));
+	}
+	
+	return set;
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n0 : Hogwild scalability." << std::endl;
+	std::cout << "A " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons << " network is trained on " << numberOfLearningPoints << " learning points with an increasing number of threads." << std::endl;
+	
+	srand(0);
+	const ENN::LearningSet learningSet = createLearningSet();
+	const unsigned maximumNumberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	
+	std::cout << "threads ; cycles ; samples/s ; speedup" << std::endl;
+	
+	double reference = 0.0;
+	for (unsigned threads=1 ; threads<=maximumNumberOfThreads ; threads*=2)
+	{
+		ENN::NeuralNetwork nn;
+		nn.setSeed(1); //Same initial weights for every run
+		createNetwork(nn);
+		nn.appendLearningSet(learningSet);
+		nn.setLearningRate(learningRate);
+		nn.setNumberOfThreads(threads);
+		nn.setParallelMode(ENN::NeuralNetwork::ParallelMode::Hogwild);
+		
+		auto start = std::chrono::steady_clock::now();
+		const unsigned cycles = nn.train();
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		
+		const double samplesPerSecond = cycles * learningSet.size() / seconds;
+		if (threads == 1)
+			reference = samplesPerSecond;
+		
+		std::cout << threads << " ; " << cycles << " ; " << samplesPerSecond << " ; " << samplesPerSecond / reference << std::endl;
+	}
+	
+	return EXIT_SUCCESS;
+}
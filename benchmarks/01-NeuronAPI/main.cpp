@@ -0,0 +1,70 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include "enn.hpp"
+
+//Same network as example 4 (chords recognition)
+const unsigned numberOfInputNeurons = 24;
+const unsigned numberOfHiddenNeurons = 32;
+const unsigned numberOfOutputNeurons = 16;
+const unsigned numberOfSteps = 2000;
+
+typedef std::vector< std::vector<ENN::Neuron *> > Neurons;
+
+//One training step written with the per-neuron API: most of the calls below check the type of the neuron
+void trainOneStep(Neurons const & neurons, ENN::LearningVector const & inputs, ENN::LearningVector const & outputs)
+{
+	for (unsigned i=0 ; i<numberOfInputNeurons ; i++)
+		neurons.front()[i]->setOutputValue(inputs[i]);
+	
+	for (unsigned l=1 ; l<neurons.size() ; l++)
+		for (ENN::Neuron * neuron : neurons[l])
+			neuron->compute();
+	
+	float error = 0.f;
+	for (unsigned i=0 ; i<numberOfOutputNeurons ; i++)
+	{
+		neurons.back()[i]->setDesiredOutputValue(outputs[i]);
+		error += neurons.back()[i]->getError();
+	}
+	
+	for (unsigned l=neurons.size()-1 ; l>0 ; l--)
+		for (ENN::Neuron * neuron : neurons[l])
+			neuron->computeDerativeOfErrorToNetValue();
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n1 : per-neuron API." << std::endl;
+	std::cout << "A " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons << " network is run " << numberOfSteps << " times through the Neuron methods, then printed." << std::endl;
+	
+	ENN::NeuralNetwork nn;
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+	
+	//The neurons are fetched once so that only the Neuron methods are measured
+	Neurons neurons(nn.getNumberOfLayers());
+	for (unsigned l=0 ; l<nn.getNumberOfLayers() ; l++)
+		for (unsigned i=0 ; i<nn.getNumberOfNeuronsOnLayer(l) ; i++)
+			neurons[l].push_back(nn.getNeuron(l, i));
+	
+	const ENN::LearningVector inputs(numberOfInputNeurons, 0.5f);
+	const ENN::LearningVector outputs(numberOfOutputNeurons, -0.5f);
+	
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned s=0 ; s<numberOfSteps ; s++)
+		trainOneStep(neurons, inputs, outputs);
+	const double stepDuration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / numberOfSteps;
+	
+	start = std::chrono::steady_clock::now();
+	const std::string formula = nn.toString();
+	const double toStringDuration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	
+	std::cout << "training step: " << stepDuration << " us" << std::endl;
+	std::cout << "toString (" << formula.size() << " characters): " << toStringDuration << " us" << std::endl;
+	
+	return EXIT_SUCCESS;
+}
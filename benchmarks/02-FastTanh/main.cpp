@@ -0,0 +1,96 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include "enn.hpp"
+
+const float range = 10.f;
+const unsigned numberOfValues = 1 << 20;
+const unsigned numberOfRepetitions = 20;
+const double maxError = 5e-7; //Bound documented in Simd::tanh
+
+//Network of example 4 (chords recognition), trained with a null learning rate so that train() stops after two cycles
+double measureTraining(bool fastActivation)
+{
+	ENN::NeuralNetwork nn;
+	nn.addLayer(24);
+	nn.addLayer(32);
+	nn.addLayer(16);
+	nn.connectAllLayers();
+	nn.setLearningRate(0.f);
+	nn.setFastActivation(fastActivation);
+	
+	srand(0);
+	for (unsigned p=0 ; p<10000 ; p++)
+	{
+		ENN::LearningVector inputs(24);
+		ENN::LearningVector outputs(16);
+		for (float & input : inputs)
+			input = (rand() % 2) - 0.5f;
+		for (float & output : outputs)
+			output = (rand() % 2) - 0.5f;
+		nn.addLearningPoint(inputs, outputs);
+	}
+	
+	const auto start = std::chrono::steady_clock::now();
+	const unsigned cycles = nn.train();
+	
+	return cycles * 10000 / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n2 : fast tanh." << std::endl;
+	std::cout << numberOfValues << " values in [" << -range << ", " << range << "] go through std::tanh and through the approximation of each instruction set." << std::endl;
+	
+	std::vector<float> x(numberOfValues);
+	std::vector<float> y(numberOfValues);
+	for (unsigned i=0 ; i<numberOfValues ; i++)
+		x[i] = -range + 2.f * range * i / (numberOfValues - 1);
+	
+	//Reference (accumulated so that the compiler cannot drop the repetitions)
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned r=0 ; r<numberOfRepetitions ; r++)
+		for (unsigned i=0 ; i<numberOfValues ; i++)
+			y[i] += std::tanh(x[i]);
+	const double referenceDuration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numberOfRepetitions / numberOfValues;
+	
+	std::cout << "std::tanh: " << referenceDuration << " ns per value" << std::endl;
+	
+	bool success = true;
+	const ENN::Simd::InstructionSet best = ENN::Simd::getBestInstructionSet();
+	
+	for (unsigned s=0 ; s<=static_cast<unsigned>(best) ; s++)
+	{
+		const ENN::Simd::InstructionSet instructionSet = static_cast<ENN::Simd::InstructionSet>(s);
+		ENN::Simd::setInstructionSet(instructionSet);
+		
+		start = std::chrono::steady_clock::now();
+		for (unsigned r=0 ; r<numberOfRepetitions ; r++)
+			ENN::Simd::tanh(x.data(), y.data(), numberOfValues);
+		const double duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / numberOfRepetitions / numberOfValues;
+		
+		double error = 0.0;
+		for (unsigned i=0 ; i<numberOfValues ; i++)
+			error = std::max(error, std::abs(y[i] - std::tanh(static_cast<double>(x[i]))));
+		
+		std::cout << ENN::Simd::toString(instructionSet) << ": " << duration << " ns per value (x" << referenceDuration / duration << "), max error " << error << std::endl;
+		success = success && error < maxError;
+	}
+	
+	ENN::Simd::setInstructionSet(best);
+	
+	const double exactSpeed = measureTraining(false);
+	const double fastSpeed = measureTraining(true);
+	std::cout << "training with std::tanh: " << exactSpeed << " learning points/s" << std::endl;
+	std::cout << "training with the fast tanh: " << fastSpeed << " learning points/s (x" << fastSpeed / exactSpeed << ")" << std::endl;
+	
+	if (!success)
+	{
+		std::cout << "The error is above the documented bound (" << maxError << ")" << std::endl;
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
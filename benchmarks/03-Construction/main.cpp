@@ -0,0 +1,82 @@
+#include <iostream>
+#include <chrono>
+#include <malloc.h>
+
+#include "enn.hpp"
+
+const unsigned numberOfNeuronsPerLayer = 1000;
+const unsigned numberOfRepetitions = 5;
+const unsigned numberOfWiredNeurons = 400; //connect() is called for each pair of neurons of two layers of this size
+
+//Memory allocated on the heap in bytes (glibc only)
+double getAllocatedMemory()
+{
+	struct mallinfo2 info = mallinfo2();
+	return static_cast<double>(info.uordblks) + static_cast<double>(info.hblkhd);
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n3 : network construction." << std::endl;
+	std::cout << "Two layers of " << numberOfNeuronsPerLayer << " neurons are fully connected with connectAllLayers(), " << numberOfRepetitions << " times." << std::endl;
+	std::cout << "Then two layers of " << numberOfWiredNeurons << " neurons are connected one connection at a time with connect(), and every connection is looked up." << std::endl;
+	
+	double duration = 0.;
+	double memory = 0.;
+	
+	for (unsigned r=0 ; r<numberOfRepetitions ; r++)
+	{
+		const double memoryBefore = getAllocatedMemory();
+		auto start = std::chrono::steady_clock::now();
+		
+		{
+			ENN::NeuralNetwork nn;
+			nn.addLayer(numberOfNeuronsPerLayer);
+			nn.addLayer(numberOfNeuronsPerLayer);
+			nn.connectAllLayers();
+			
+			duration += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			memory += getAllocatedMemory() - memoryBefore;
+		}
+	}
+	
+	const double numberOfConnections = static_cast<double>(numberOfNeuronsPerLayer) * numberOfNeuronsPerLayer;
+	
+	std::cout << "Construction time: " << duration / numberOfRepetitions << " ms (" << duration / numberOfRepetitions * 1e6 / numberOfConnections << " ns per connection)" << std::endl;
+	std::cout << "Memory: " << memory / numberOfRepetitions / (1 << 20) << " MiB (" << memory / numberOfRepetitions / numberOfConnections << " bytes per connection, the weight matrices included)" << std::endl;
+	
+	//Custom wiring: connect() checks that the connection does not exist yet, then connectionExists() and setConnectionWeight() look each one up
+	ENN::NeuralNetwork nn;
+	nn.addLayer(numberOfWiredNeurons);
+	nn.addLayer(numberOfWiredNeurons);
+	
+	auto start = std::chrono::steady_clock::now();
+	
+	for (unsigned i=0 ; i<numberOfWiredNeurons ; i++)
+		for (unsigned j=0 ; j<numberOfWiredNeurons ; j++)
+			nn.connect(0, i, 1, j);
+	
+	const double connectDuration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	start = std::chrono::steady_clock::now();
+	
+	unsigned numberOfConnectionsFound = 0;
+	for (unsigned i=0 ; i<numberOfWiredNeurons ; i++)
+	{
+		for (unsigned j=0 ; j<numberOfWiredNeurons ; j++)
+		{
+			if (nn.connectionExists(0, i, 1, j))
+			{
+				nn.setConnectionWeight(0, i, 1, j, 0.1f);
+				numberOfConnectionsFound++;
+			}
+		}
+	}
+	
+	const double lookupDuration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	const double numberOfWiredConnections = static_cast<double>(numberOfWiredNeurons) * numberOfWiredNeurons;
+	
+	std::cout << "connect() loop: " << connectDuration << " ms (" << connectDuration * 1e6 / numberOfWiredConnections << " ns per connection)" << std::endl;
+	std::cout << "connectionExists() and setConnectionWeight() loop: " << lookupDuration << " ms (" << lookupDuration * 1e6 / numberOfWiredConnections << " ns per connection, " << numberOfConnectionsFound << " found)" << std::endl;
+	
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+#include "enn.hpp"
+
+const unsigned numberOfInputNeurons = 2;
+const unsigned numberOfHiddenNeurons = 12;
+const unsigned numberOfOutputNeurons = 1;
+const unsigned numberOfPoints = 512;
+const unsigned populationSize = 128;
+const unsigned numberOfGenerations = 100;
+const unsigned seed = 42;
+
+//Builds the same network and learning set every time (the weights of the network are the ones of the first individual only)
+void buildNetwork(ENN::NeuralNetwork & nn)
+{
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	srand(seed);
+	nn.setSeed(seed);
+	nn.connectAllLayers();
+	
+	for (unsigned p=0 ; p<numberOfPoints ; p++)
+	{
+		const float x = (p % 32) / 16.f - 1.f;
+		const float y = (p / 32) / 8.f - 1.f;
+		nn.addLearningPoint({x, y}, {0.5f * std::sin(3.f * x) * std::cos(2.f * y)});
+	}
+}
+
+//Returns the error of the best individual and prints the duration of a generation
+float run(unsigned numberOfThreads)
+{
+	ENN::NeuralNetwork nn;
+	buildNetwork(nn);
+	
+	ENN::GeneticTrainer trainer(nn, seed);
+	trainer.setPopulationSize(populationSize);
+	trainer.setNumberOfThreads(numberOfThreads);
+	
+	auto start = std::chrono::steady_clock::now();
+	const float error = trainer.train(numberOfGenerations);
+	const double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	
+	std::cout << numberOfThreads << " thread(s): " << duration / numberOfGenerations << " ms per generation ("
+	          << populationSize * numberOfPoints * numberOfGenerations / duration / 1e3 << " M learning points evaluated per second), best error " << error << std::endl;
+	
+	return error;
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n4 : genetic algorithm." << std::endl;
+	std::cout << "A population of " << populationSize << " " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons
+	          << " networks evolves for " << numberOfGenerations << " generations on " << numberOfPoints << " learning points." << std::endl;
+	
+	ENN::NeuralNetwork nn;
+	buildNetwork(nn);
+	ENN::GeneticTrainer initial(nn, seed);
+	std::cout << "Error of the initial population: " << initial.train(0) << std::endl;
+	
+	const float sequentialError = run(1);
+	const unsigned numberOfThreads = std::max(2u, std::thread::hardware_concurrency());
+	const float parallelError = run(numberOfThreads);
+	
+	//The individuals are created on the calling thread, so the result only depends on the seed
+	if (sequentialError != parallelError)
+	{
+		std::cout << "The result depends on the number of threads" << std::endl;
+		return 1;
+	}
+	
+	std::cout << "Same result with 1 and " << numberOfThreads << " threads" << std::endl;
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include "enn.hpp"
+
+const unsigned numberOfHiddenNeurons = 16;
+const unsigned numberOfSequences = 64;
+const unsigned sequenceLength = 20;
+const unsigned truncationLength = 5;
+const unsigned delay = 2;
+const unsigned numberOfProcessedSequences = 4096;
+const unsigned seed = 42;
+
+//Each input is drawn in [-0.5, 0.5], the desired output is the input of delay time steps before (0 at the beginning)
+float randomInput()
+{
+	return static_cast<float>(rand()) / RAND_MAX - 0.5f;
+}
+
+void buildSequence(std::vector<ENN::LearningVector> & inputs, std::vector<ENN::LearningVector> & outputs)
+{
+	inputs.clear();
+	outputs.clear();
+	
+	for (unsigned t=0 ; t<sequenceLength ; t++)
+	{
+		inputs.push_back({randomInput()});
+		outputs.push_back({t < delay ? 0.f : inputs[t - delay][0]});
+	}
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n5 : recurrent layer." << std::endl;
+	std::cout << "A 1x" << numberOfHiddenNeurons << "x1 network with a recurrent hidden layer learns to repeat its input " << delay << " time steps later, on "
+	          << numberOfSequences << " sequences of " << sequenceLength << " steps (truncated backpropagation through time over " << truncationLength << " steps)." << std::endl;
+	
+	srand(seed);
+	ENN::NeuralNetwork nn;
+	nn.setSeed(seed);
+	nn.addLayer(1);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(1);
+	nn.connectAllLayers();
+	nn.setRecurrent(1);
+	nn.setActivation(2, ENN::Activation::Linear);
+	nn.setLearningRate(0.02f);
+	nn.setTruncationLength(truncationLength);
+	
+	std::vector<ENN::LearningVector> inputs, outputs;
+	
+	for (unsigned s=0 ; s<numberOfSequences ; s++)
+	{
+		buildSequence(inputs, outputs);
+		nn.addLearningSequence(inputs, outputs);
+	}
+	
+	auto start = std::chrono::steady_clock::now();
+	const unsigned cycles = nn.train();
+	double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	
+	std::cout << "Training: " << cycles << " cycles, " << duration / cycles << " ms per cycle ("
+	          << numberOfSequences * sequenceLength * cycles / duration / 1e3 << " M time steps per second)" << std::endl;
+	
+	//Error on new sequences, once the output depends on inputs which are not in the network anymore
+	float error = 0.f;
+	
+	for (unsigned s=0 ; s<16 ; s++)
+	{
+		buildSequence(inputs, outputs);
+		std::vector<ENN::LearningVector> results = nn.processSequence(inputs);
+		
+		for (unsigned t=0 ; t<sequenceLength ; t++)
+			error += std::abs(results[t][0] - outputs[t][0]) / (16 * sequenceLength);
+	}
+	
+	std::cout << "Mean absolute error on new sequences: " << error << " (inputs have a mean absolute value of 0.25)" << std::endl;
+	
+	//Inference: one sequence at a time, then blocks of sequences processed together at each time step
+	std::vector<float> allInputs(numberOfProcessedSequences * sequenceLength);
+	std::vector<float> batchOutputs(allInputs.size());
+	std::vector<float> sequenceOutputs(allInputs.size());
+	
+	for (float & input : allInputs)
+		input = randomInput();
+	
+	start = std::chrono::steady_clock::now();
+	for (unsigned s=0 ; s<numberOfProcessedSequences ; s++)
+		nn.processSequences(&allInputs[s * sequenceLength], 1, sequenceLength, &sequenceOutputs[s * sequenceLength]);
+	duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "One sequence at a time: " << numberOfProcessedSequences * sequenceLength / duration / 1e3 << " M time steps per second" << std::endl;
+	
+	start = std::chrono::steady_clock::now();
+	nn.processSequences(allInputs.data(), numberOfProcessedSequences, sequenceLength, batchOutputs.data());
+	duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Sequence batches: " << numberOfProcessedSequences * sequenceLength / duration / 1e3 << " M time steps per second" << std::endl;
+	
+	float difference = 0.f;
+	for (unsigned k=0 ; k<allInputs.size() ; k++)
+		difference = std::max(difference, std::abs(batchOutputs[k] - sequenceOutputs[k]));
+	
+	std::cout << "Largest difference between the two: " << difference << std::endl;
+	return 0;
+}
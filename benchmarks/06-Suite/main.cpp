@@ -0,0 +1,242 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <malloc.h>
+
+#include "enn.hpp"
+
+/* Non-interactive benchmark suite, launched by 'make bench' at the root of the repository.
+ * For each topology it measures the construction of the network, the loading of its model file, the latency of process() and processBatch() and the training throughput,
+ * prints a summary and writes all the results to a JSON file (first argument, bench.json by default) so that releases can be compared.
+ */
+
+const unsigned numberOfLatencySamples = 2000; //Latencies are measured call by call, then sorted for the percentiles
+const unsigned batchSize = 64;
+const double workPerTopology = 2e8; //Number of weight multiplications of the training measure, so that every topology takes about the same time
+const unsigned seed = 42;
+const std::string modelFileName = "benchmark06.model"; //Written and removed for each topology
+
+struct Topology
+{
+	std::string name;
+	std::vector<unsigned> layerSizes;
+};
+
+struct Percentiles
+{
+	double p50;
+	double p99;
+};
+
+struct Result
+{
+	Topology topology;
+	unsigned numberOfConnections;
+	double constructionTime; //ms
+	double memory; //bytes
+	double loadTime; //ms, load() of the saved network
+	double copyTime; //ms, Model built from the network
+	Percentiles processLatency; //us per call
+	Percentiles batchLatency; //us per batch of batchSize samples
+	double trainingThroughput; //learning points per second
+	unsigned numberOfTrainingPoints;
+};
+
+//Memory allocated on the heap in bytes (glibc only)
+double getAllocatedMemory()
+{
+	struct mallinfo2 info = mallinfo2();
+	return static_cast<double>(info.uordblks) + static_cast<double>(info.hblkhd);
+}
+
+double getElapsedTime(std::chrono::steady_clock::time_point start) //us
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+Percentiles getPercentiles(std::vector<double> & durations)
+{
+	std::sort(durations.begin(), durations.end());
+	return {durations[durations.size() / 2], durations[durations.size() * 99 / 100]};
+}
+
+float randomValue()
+{
+	return static_cast<float>(rand()) / RAND_MAX - 0.5f;
+}
+
+ENN::LearningVector randomVector(unsigned size)
+{
+	ENN::LearningVector vector(size);
+	for (float & value : vector)
+		value = randomValue();
+	
+	return vector;
+}
+
+Result run(Topology const & topology)
+{
+	Result result;
+	result.topology = topology;
+	srand(seed);
+	
+	ENN::NeuralNetwork nn;
+	nn.setSeed(seed);
+	const double memoryBefore = getAllocatedMemory();
+	auto start = std::chrono::steady_clock::now();
+	
+	for (unsigned size : topology.layerSizes)
+		nn.addLayer(size);
+	
+	nn.connectAllLayers();
+	
+	result.constructionTime = getElapsedTime(start) / 1e3;
+	result.memory = getAllocatedMemory() - memoryBefore;
+	result.numberOfConnections = 0;
+	
+	for (unsigned l=1 ; l<topology.layerSizes.size() ; l++)
+		result.numberOfConnections += topology.layerSizes[l] * topology.layerSizes[l-1];
+	
+	//The file was just written so it is in the page cache, this measures load() rather than the disk
+	nn.save(modelFileName);
+	
+	{
+		ENN::NeuralNetwork loaded;
+		start = std::chrono::steady_clock::now();
+		loaded.load(modelFileName);
+		result.loadTime = getElapsedTime(start) / 1e3;
+	}
+	
+	std::remove(modelFileName.c_str());
+	start = std::chrono::steady_clock::now();
+	
+	{
+		ENN::Model model(nn);
+		result.copyTime = getElapsedTime(start) / 1e3;
+	}
+	
+	const unsigned numberOfInputs = topology.layerSizes.front();
+	const unsigned numberOfOutputs = topology.layerSizes.back();
+	
+	//Latency of a single sample
+	std::vector<ENN::LearningVector> inputs;
+	for (unsigned s=0 ; s<batchSize ; s++)
+		inputs.push_back(randomVector(numberOfInputs));
+	
+	std::vector<double> durations;
+	
+	for (unsigned r=0 ; r<numberOfLatencySamples ; r++)
+	{
+		start = std::chrono::steady_clock::now();
+		nn.process(inputs[r % batchSize]);
+		durations.push_back(getElapsedTime(start));
+	}
+	
+	result.processLatency = getPercentiles(durations);
+	
+	//Latency of a batch
+	std::vector<float> outputs(batchSize * numberOfOutputs);
+	durations.clear();
+	
+	for (unsigned r=0 ; r<numberOfLatencySamples / 10 ; r++)
+	{
+		start = std::chrono::steady_clock::now();
+		nn.processBatch(inputs, outputs.data());
+		durations.push_back(getElapsedTime(start));
+	}
+	
+	result.batchLatency = getPercentiles(durations);
+	
+	//Training throughput: with a null learning rate the error does not change, so train() stops after exactly two cycles of full forward and backward passes
+	result.numberOfTrainingPoints = std::max(64u, static_cast<unsigned>(workPerTopology / 3 / 2 / result.numberOfConnections));
+	
+	for (unsigned p=0 ; p<result.numberOfTrainingPoints ; p++)
+		nn.addLearningPoint(randomVector(numberOfInputs), randomVector(numberOfOutputs));
+	
+	nn.setLearningRate(0.f);
+	start = std::chrono::steady_clock::now();
+	const unsigned cycles = nn.train();
+	result.trainingThroughput = cycles * result.numberOfTrainingPoints / (getElapsedTime(start) / 1e6);
+	
+	return result;
+}
+
+void writeJson(std::ostream & json, std::vector<Result> const & results)
+{
+	json << std::setprecision(6);
+	json << "{\n";
+	json << "  \"benchmark\": \"ENNlib suite\",\n";
+	json << "  \"instructionSet\": \"" << ENN::Simd::toString(ENN::Simd::getInstructionSet()) << "\",\n";
+	json << "  \"batchSize\": " << batchSize << ",\n";
+	json << "  \"results\": [\n";
+	
+	for (unsigned k=0 ; k<results.size() ; k++)
+	{
+		Result const & r = results[k];
+		
+		json << "    {\n";
+		json << "      \"name\": \"" << r.topology.name << "\",\n";
+		json << "      \"layers\": [";
+		for (unsigned l=0 ; l<r.topology.layerSizes.size() ; l++)
+			json << (l ? ", " : "") << r.topology.layerSizes[l];
+		json << "],\n";
+		json << "      \"connections\": " << r.numberOfConnections << ",\n";
+		json << "      \"constructionMs\": " << r.constructionTime << ",\n";
+		json << "      \"memoryBytes\": " << static_cast<long long>(r.memory) << ",\n";
+		json << "      \"loadMs\": " << r.loadTime << ",\n";
+		json << "      \"modelCopyMs\": " << r.copyTime << ",\n";
+		json << "      \"processUs\": {\"p50\": " << r.processLatency.p50 << ", \"p99\": " << r.processLatency.p99 << "},\n";
+		json << "      \"batchUs\": {\"p50\": " << r.batchLatency.p50 << ", \"p99\": " << r.batchLatency.p99 << "},\n";
+		json << "      \"trainPoints\": " << r.numberOfTrainingPoints << ",\n";
+		json << "      \"trainSamplesPerSecond\": " << r.trainingThroughput << "\n";
+		json << "    }" << (k+1 < results.size() ? "," : "") << "\n";
+	}
+	
+	json << "  ]\n";
+	json << "}\n";
+}
+
+int main(int argc, char ** argv)
+{
+	const std::string fileName = argc > 1 ? argv[1] : "bench.json";
+	
+	//The chord topology is the one of example 04, the others are a matrix of square networks
+	std::vector<Topology> topologies = {{"example04 chords", {24, 32, 16}}};
+	
+	for (unsigned size : {16u, 64u, 256u, 1024u})
+	{
+		topologies.push_back({std::to_string(size) + "x" + std::to_string(size) + "x" + std::to_string(size), {size, size, size}});
+		topologies.push_back({"deep " + std::to_string(size), {size, size, size, size, size, size}});
+	}
+	
+	std::cout << "ENNlib benchmark n6 : suite (" << ENN::Simd::toString(ENN::Simd::getInstructionSet()) << " kernels)." << std::endl;
+	std::cout << std::left << std::setw(18) << "topology" << std::right << std::setw(12) << "connections" << std::setw(13) << "build (ms)" << std::setw(12) << "memory (B)" << std::setw(11) << "load (ms)" << std::setw(11) << "copy (ms)"
+	          << std::setw(14) << "process p50" << std::setw(13) << "process p99" << std::setw(12) << "batch p50" << std::setw(12) << "batch p99" << std::setw(16) << "train (pts/s)" << std::endl;
+	
+	std::vector<Result> results;
+	
+	for (Topology const & topology : topologies)
+	{
+		results.push_back(run(topology));
+		Result const & r = results.back();
+		
+		std::cout << std::left << std::setw(18) << r.topology.name << std::right << std::setw(12) << r.numberOfConnections << std::setw(13) << r.constructionTime << std::setw(12) << static_cast<long long>(r.memory) << std::setw(11) << r.loadTime << std::setw(11) << r.copyTime
+		          << std::setw(14) << r.processLatency.p50 << std::setw(13) << r.processLatency.p99 << std::setw(12) << r.batchLatency.p50 << std::setw(12) << r.batchLatency.p99 << std::setw(16) << r.trainingThroughput << std::endl;
+	}
+	
+	std::cout << "(latencies in us, a batch is " << batchSize << " samples)" << std::endl;
+	
+	std::ofstream json(fileName);
+	writeJson(json, results);
+	
+	if (!json.good())
+	{
+		std::cerr << "Cannot write " << fileName << std::endl;
+		return 1;
+	}
+	
+	std::cout << "Results written to " << fileName << std::endl;
+	return 0;
+}
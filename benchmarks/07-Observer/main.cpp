@@ -0,0 +1,125 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include "enn.hpp"
+
+const unsigned numberOfInputNeurons = 32;
+const unsigned numberOfHiddenNeurons = 128;
+const unsigned numberOfOutputNeurons = 16;
+const unsigned numberOfPoints = 128;
+const unsigned numberOfRepetitions = 3;
+const unsigned seed = 42;
+
+//Keeps the statistics of every cycle and prints one line out of printInterval
+class CycleLogger : public ENN::TrainingObserver
+{
+	public:
+
+		CycleLogger(unsigned printInterval) : _printInterval(printInterval), _totalTime(0.), _phaseTime(0.) {}
+
+		void onCycleEnd(ENN::TrainingStatistics const & statistics) override
+		{
+			_totalTime += statistics.duration;
+			_phaseTime += statistics.forwardTime + statistics.backwardTime + statistics.updateTime;
+
+			if (statistics.cycle % _printInterval != 0)
+				return;
+
+			std::cout << std::setw(6) << statistics.cycle << std::setw(12) << statistics.error << std::setw(12) << statistics.pointsPerSecond
+			          << std::setw(11) << statistics.forwardTime * 1e3 << std::setw(11) << statistics.backwardTime * 1e3 << std::setw(11) << statistics.updateTime * 1e3
+			          << std::setw(14) << statistics.gradientNorm << std::endl;
+		}
+
+		void onTrainingEnd(unsigned numberOfCycles, float error) override
+		{
+			std::cout << "Training over after " << numberOfCycles << " cycles, error " << error << ", "
+			          << 100. * _phaseTime / _totalTime << "% of the time is in the measured phases" << std::endl;
+		}
+
+
+	private:
+
+		unsigned _printInterval;
+		double _totalTime;
+		double _phaseTime;
+};
+
+//Only makes the network measure its statistics, to get the cost of the instrumentation alone
+class SilentObserver : public ENN::TrainingObserver
+{
+	public:
+
+		void onCycleEnd(ENN::TrainingStatistics const &) override {}
+};
+
+//Builds the same network and learning set every time
+void buildNetwork(ENN::NeuralNetwork & nn)
+{
+	srand(seed);
+	nn.setSeed(seed);
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+	nn.setLearningRate(0.01f);
+	
+	for (unsigned p=0 ; p<numberOfPoints ; p++)
+	{
+		ENN::LearningVector inputs(numberOfInputNeurons);
+		ENN::LearningVector outputs(numberOfOutputNeurons);
+		
+		for (float & input : inputs)
+			input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+		
+		for (unsigned i=0 ; i<numberOfOutputNeurons ; i++)
+			outputs[i] = 0.5f * std::sin(3.f * inputs[i] * inputs[i+16]);
+		
+		nn.addLearningPoint(inputs, outputs);
+	}
+}
+
+//Returns the time per cycle in ms
+double run(std::shared_ptr<ENN::TrainingObserver> observer, unsigned batchSize)
+{
+	ENN::NeuralNetwork nn;
+	buildNetwork(nn);
+	nn.setBatchSize(batchSize);
+	
+	if (observer)
+		nn.addTrainingObserver(observer);
+	
+	auto start = std::chrono::steady_clock::now();
+	const unsigned cycles = nn.train();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / cycles;
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n7 : training observer." << std::endl;
+	std::cout << "A " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons << " network is trained on " << numberOfPoints
+	          << " learning points, with and without an observer collecting the statistics of each cycle." << std::endl << std::endl;
+	
+	std::cout << std::setw(6) << "cycle" << std::setw(12) << "error" << std::setw(12) << "points/s" << std::setw(11) << "fwd (ms)" << std::setw(11) << "bwd (ms)"
+	          << std::setw(11) << "upd (ms)" << std::setw(14) << "gradient norm" << std::endl;
+	run(std::make_shared<CycleLogger>(20), 1);
+	std::cout << std::endl;
+	
+	for (unsigned batchSize : {1u, 32u})
+	{
+		//Best of a few runs, the machine noise is larger than the cost of the observer
+		double withoutObserver = std::numeric_limits<double>::max();
+		double withObserver = std::numeric_limits<double>::max();
+		
+		for (unsigned r=0 ; r<numberOfRepetitions ; r++)
+		{
+			withoutObserver = std::min(withoutObserver, run(nullptr, batchSize));
+			withObserver = std::min(withObserver, run(std::make_shared<SilentObserver>(), batchSize));
+		}
+		
+		std::cout << "Batch size " << batchSize << ": " << withoutObserver << " ms per cycle without observer, " << withObserver << " ms with an observer ("
+		          << std::showpos << 100. * (withObserver / withoutObserver - 1.) << std::noshowpos << "%)" << std::endl;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+
+#include "enn.hpp"
+
+const unsigned numberOfMessages = 20000;
+const unsigned numberOfMessagesPerBurst = 1000; //The logger thread gets some time between two bursts, like between two training cycles
+const std::string logFileName = "benchmark08.log";
+
+struct Latencies
+{
+	double mean;
+	double p99;
+	double maximum;
+};
+
+//Calls f numberOfMessages times and measures each call in ns
+template <class Function>
+Latencies measure(Function f)
+{
+	std::vector<double> durations;
+	durations.reserve(numberOfMessages);
+	
+	for (unsigned m=0 ; m<numberOfMessages ; m++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		f(m);
+		durations.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+		
+		if ((m + 1) % numberOfMessagesPerBurst == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	
+	double sum = 0.;
+	for (double d : durations)
+		sum += d;
+	
+	std::sort(durations.begin(), durations.end());
+	return {sum / durations.size(), durations[durations.size() * 99 / 100], durations.back()};
+}
+
+void print(std::string const & name, Latencies const & latencies)
+{
+	std::cout << name << ": mean " << latencies.mean << " ns, p99 " << latencies.p99 << " ns, max " << latencies.maximum / 1e3 << " us per message" << std::endl;
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n8 : logger." << std::endl;
+	std::cout << numberOfMessages << " errors are logged to " << logFileName << " by invalid getNeuron() calls, in bursts of " << numberOfMessagesPerBurst << "." << std::endl;
+	
+	ENN::NeuralNetwork nn;
+	nn.addLayer(4);
+	
+	//What the macros used to do: format and write the message with a flush, on the calling thread
+	{
+		std::ofstream file(logFileName);
+		
+		print("Synchronous write with std::endl", measure([&](unsigned m)
+		{
+			file << "[ERROR]" << " (" << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << ") " << "Neuron (0, " << m << ") does not exist" << "." << std::endl;
+		}));
+	}
+	
+	std::ofstream file(logFileName);
+	ENN::Logger::getInstance().setSink(std::make_shared<ENN::StreamSink>(file));
+	
+	print("Logger", measure([&](unsigned m)
+	{
+		nn.getNeuron(0, 4 + m);
+	}));
+	
+	ENN::Logger::getInstance().flush();
+	std::cout << ENN::Logger::getInstance().getNumberOfDroppedMessages() << " messages dropped (the buffer holds " << ENN::Logger::Capacity << ")" << std::endl;
+	
+	ENN::Logger::getInstance().setSink(std::make_shared<ENN::StreamSink>());
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+
+#include "enn.hpp"
+
+const unsigned numberOfInputNeurons = 16;
+const unsigned numberOfHiddenNeurons = 64;
+const unsigned numberOfOutputNeurons = 4;
+const unsigned numberOfPoints = 256;
+const unsigned numberOfValidationPoints = 64;
+const unsigned patience = 20;
+const unsigned maximumNumberOfCycles = 400;
+const unsigned numberOfRepetitions = 3;
+const std::string checkpointFileName("checkpoint.enn");
+const unsigned seed = 42;
+
+//Builds the same network, learning set and validation set every time, the outputs are noisy so that the network ends up overfitting
+void buildNetwork(ENN::NeuralNetwork & nn, bool validation)
+{
+	srand(seed);
+	nn.setSeed(seed);
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+	nn.setLearningRate(0.05f);
+	nn.setMaximumNumberOfCycles(maximumNumberOfCycles);
+	
+	for (unsigned p=0 ; p<numberOfPoints+numberOfValidationPoints ; p++)
+	{
+		ENN::LearningVector inputs(numberOfInputNeurons);
+		ENN::LearningVector outputs(numberOfOutputNeurons);
+		
+		for (float & input : inputs)
+			input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+		
+		for (unsigned i=0 ; i<numberOfOutputNeurons ; i++)
+			outputs[i] = 0.5f * std::sin(3.f * inputs[i] * inputs[i+4]) + 0.2f * (static_cast<float>(rand()) / RAND_MAX - 0.5f);
+		
+		if (p < numberOfPoints)
+			nn.addLearningPoint(inputs, outputs);
+		else if (validation)
+			nn.addValidationPoint(inputs, outputs);
+	}
+}
+
+//Returns the time per cycle in ms
+double timeCycles(ENN::NeuralNetwork & nn, unsigned & cycles)
+{
+	auto start = std::chrono::steady_clock::now();
+	cycles = nn.train();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / cycles;
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n9 : early stopping and checkpoints." << std::endl;
+	std::cout << "A " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons << " network is trained on " << numberOfPoints
+	          << " noisy learning points and validated on " << numberOfValidationPoints << " other points, for at most " << maximumNumberOfCycles << " cycles." << std::endl << std::endl;
+	
+	//Cost of each feature per cycle, best of a few runs
+	double plain = std::numeric_limits<double>::max();
+	double validated = std::numeric_limits<double>::max();
+	double checkpointed = std::numeric_limits<double>::max();
+	unsigned cycles = 0;
+	
+	for (unsigned r=0 ; r<numberOfRepetitions ; r++)
+	{
+		ENN::NeuralNetwork withoutValidation;
+		buildNetwork(withoutValidation, false);
+		plain = std::min(plain, timeCycles(withoutValidation, cycles));
+		
+		ENN::NeuralNetwork withValidation;
+		buildNetwork(withValidation, true);
+		validated = std::min(validated, timeCycles(withValidation, cycles));
+		
+		ENN::NeuralNetwork withCheckpoints;
+		buildNetwork(withCheckpoints, false);
+		withCheckpoints.setCheckpoint(checkpointFileName, 1);
+		checkpointed = std::min(checkpointed, timeCycles(withCheckpoints, cycles));
+	}
+	
+	std::cout << std::setw(42) << std::left << "Training alone: " << plain << " ms per cycle" << std::endl;
+	std::cout << std::setw(42) << "Validation error after each cycle: " << validated << " ms per cycle (" << std::showpos << 100. * (validated / plain - 1.) << std::noshowpos << "%)" << std::endl;
+	std::cout << std::setw(42) << "Checkpoint after each cycle: " << checkpointed << " ms per cycle (" << std::showpos << 100. * (checkpointed / plain - 1.) << std::noshowpos << "%)" << std::endl;
+	std::cout << std::endl;
+	
+	//The same training with and without early stopping
+	for (unsigned p : {0u, patience})
+	{
+		ENN::NeuralNetwork nn;
+		buildNetwork(nn, true);
+		nn.setPatience(p);
+		
+		const double time = timeCycles(nn, cycles) * cycles;
+		std::cout << (p == 0 ? "Without early stopping: " : "With a patience of " + std::to_string(p) + " cycles: ") << cycles << " cycles in " << time << " ms, validation error "
+		          << nn.getValidationError() << " (" << ENN::NeuralNetwork::toString(nn.getStopReason()) << ")" << std::endl;
+	}
+	
+	std::remove(checkpointFileName.c_str());
+	
+	return 0;
+}
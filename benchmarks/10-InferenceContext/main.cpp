@@ -0,0 +1,119 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <malloc.h>
+
+#include "enn.hpp"
+
+const unsigned numberOfInputNeurons = 256;
+const unsigned numberOfHiddenNeurons = 512;
+const unsigned numberOfOutputNeurons = 16;
+const unsigned numberOfThreads = 4;
+const unsigned numberOfSamples = 2000;
+const unsigned seed = 42;
+
+//Memory allocated on the heap in bytes (glibc only)
+double getAllocatedMemory()
+{
+	struct mallinfo2 info = mallinfo2();
+	return static_cast<double>(info.uordblks) + static_cast<double>(info.hblkhd);
+}
+
+void buildNetwork(ENN::NeuralNetwork & nn)
+{
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+}
+
+//Each thread processes all the samples one by one, returns the number of samples per second of all the threads together
+template <class Process>
+double run(Process process)
+{
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	
+	for (unsigned t=0 ; t<numberOfThreads ; t++)
+		threads.emplace_back(process, t);
+	
+	for (std::thread & thread : threads)
+		thread.join();
+	
+	return numberOfThreads * numberOfSamples / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n10 : inference context." << std::endl;
+	std::cout << numberOfThreads << " threads process " << numberOfSamples << " samples each with a " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x"
+	          << numberOfHiddenNeurons << "x" << numberOfOutputNeurons << " network, using one copy of the network per thread or one model shared by all the threads." << std::endl << std::endl;
+	
+	srand(seed);
+	ENN::NeuralNetwork original;
+	original.setSeed(seed);
+	buildNetwork(original);
+	
+	std::vector<float> weights(original.getNumberOfWeights());
+	original.getWeights(weights.data());
+	
+	std::vector<float> inputs(static_cast<std::size_t>(numberOfSamples) * numberOfInputNeurons);
+	for (float & input : inputs)
+		input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+	
+	//One copy of the network per thread
+	double memory = getAllocatedMemory();
+	std::vector< std::unique_ptr<ENN::NeuralNetwork> > copies;
+	
+	for (unsigned t=0 ; t<numberOfThreads ; t++)
+	{
+		copies.emplace_back(new ENN::NeuralNetwork);
+		buildNetwork(*copies.back());
+		copies.back()->setWeights(weights.data());
+	}
+	
+	const double copiesMemory = getAllocatedMemory() - memory;
+	
+	const double copiesThroughput = run([&](unsigned t)
+	{
+		ENN::LearningVector sample(numberOfInputNeurons);
+		
+		for (unsigned s=0 ; s<numberOfSamples ; s++)
+		{
+			std::copy(&inputs[s * numberOfInputNeurons], &inputs[(s + 1) * numberOfInputNeurons], sample.begin());
+			copies[t]->process(sample);
+		}
+	});
+	
+	copies.clear();
+	
+	//One model, one context per thread (the model is mapped memory, so its size is counted apart)
+	original.save("model.enn");
+	std::shared_ptr<ENN::Model const> model = std::make_shared<ENN::Model const>(std::string("model.enn"));
+	std::remove("model.enn");
+	
+	memory = getAllocatedMemory();
+	std::vector< std::unique_ptr<ENN::InferenceContext> > contexts;
+	
+	for (unsigned t=0 ; t<numberOfThreads ; t++)
+		contexts.emplace_back(new ENN::InferenceContext(model));
+	
+	const double contextsMemory = getAllocatedMemory() - memory;
+	const double modelMemory = ENN::ModelFile::Layout(std::vector<uint32_t>{numberOfInputNeurons, numberOfHiddenNeurons, numberOfHiddenNeurons, numberOfOutputNeurons}, 0).fileSize;
+	
+	const double contextsThroughput = run([&](unsigned t)
+	{
+		std::vector<float> outputs(numberOfOutputNeurons);
+		
+		for (unsigned s=0 ; s<numberOfSamples ; s++)
+			contexts[t]->process(&inputs[s * numberOfInputNeurons], outputs.data());
+	});
+	
+	std::cout << "One network per thread: " << copiesMemory / 1e6 << " MB, " << copiesThroughput << " samples/s" << std::endl;
+	std::cout << "Shared model:           " << (modelMemory + contextsMemory) / 1e6 << " MB (" << modelMemory / 1e6 << " MB of mapped model, "
+	          << contextsMemory / 1e3 / numberOfThreads << " kB per context), " << contextsThroughput << " samples/s" << std::endl;
+	
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include "enn.hpp"
+
+const unsigned numberOfNeurons = 512;
+const unsigned numberOfOutputNeurons = 8;
+const unsigned numberOfSamples = 256;
+const unsigned numberOfPoints = 64;
+const unsigned numberOfCycles = 3;
+const unsigned seed = 42;
+
+//Two hidden layers whose neurons get each input with the probability fillRatio (like a network built with connect()), sparse or dense kernels
+void buildNetwork(ENN::NeuralNetwork & nn, float fillRatio, bool sparse)
+{
+	srand(seed);
+	nn.setSeed(seed);
+	nn.setSparseThreshold(sparse ? 1.f : 0.f);
+	nn.addLayer(numberOfNeurons);
+	nn.addLayer(numberOfNeurons);
+	nn.addLayer(numberOfNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	
+	for (unsigned l=1 ; l<nn.getNumberOfLayers() ; l++)
+		for (unsigned i=0 ; i<nn.getNumberOfNeuronsOnLayer(l) ; i++)
+			for (unsigned j=0 ; j<nn.getNumberOfNeuronsOnLayer(l-1) ; j++)
+				if (l + 1 == nn.getNumberOfLayers() || static_cast<float>(rand()) / RAND_MAX < fillRatio)
+					nn.connect(l-1, j, l, i);
+	
+	nn.setLearningRate(0.001f);
+	nn.setMaximumNumberOfCycles(numberOfCycles);
+	
+	for (unsigned p=0 ; p<numberOfPoints ; p++)
+	{
+		ENN::LearningVector inputs(numberOfNeurons);
+		ENN::LearningVector outputs(numberOfOutputNeurons, 0.1f);
+		
+		for (float & input : inputs)
+			input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+		
+		nn.addLearningPoint(inputs, outputs);
+	}
+}
+
+double getElapsedTime(std::chrono::steady_clock::time_point start) //us
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n11 : sparse layers." << std::endl;
+	std::cout << "A " << numberOfNeurons << "x" << numberOfNeurons << "x" << numberOfNeurons << "x" << numberOfOutputNeurons
+	          << " network whose hidden layers are partially connected, computed with the dense or the sparse kernels (times in us per sample)." << std::endl << std::endl;
+	
+	std::vector<float> inputs(numberOfSamples * numberOfNeurons);
+	for (float & input : inputs)
+		input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+	
+	std::vector<float> outputs(numberOfSamples * numberOfOutputNeurons);
+	ENN::LearningVector sample(inputs.begin(), inputs.begin() + numberOfNeurons);
+	
+	std::cout << std::setw(6) << "fill" << std::setw(24) << "process dense/sparse" << std::setw(24) << "batch dense/sparse" << std::setw(24) << "train dense/sparse" << std::endl;
+	
+	for (float fillRatio : {0.01f, 0.02f, 0.05f, 0.1f, 0.2f, 0.5f})
+	{
+		double times[3][2];
+		
+		for (bool sparse : {false, true})
+		{
+			ENN::NeuralNetwork nn;
+			buildNetwork(nn, fillRatio, sparse);
+			nn.process(sample);
+			
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned s=0 ; s<numberOfSamples ; s++)
+				nn.process(sample);
+			times[0][sparse] = getElapsedTime(start) / numberOfSamples;
+			
+			start = std::chrono::steady_clock::now();
+			nn.processBatch(inputs.data(), numberOfSamples, outputs.data());
+			times[1][sparse] = getElapsedTime(start) / numberOfSamples;
+			
+			start = std::chrono::steady_clock::now();
+			const unsigned cycles = nn.train();
+			times[2][sparse] = getElapsedTime(start) / (cycles * numberOfPoints);
+		}
+		
+		std::cout << std::setw(6) << fillRatio;
+		
+		for (unsigned k=0 ; k<3 ; k++)
+			std::cout << std::setw(13) << std::fixed << std::setprecision(1) << times[k][0] << " /" << std::setw(7) << times[k][1] << std::defaultfloat << std::setprecision(6);
+		
+		std::cout << std::endl;
+	}
+	
+	return 0;
+}
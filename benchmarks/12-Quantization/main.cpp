@@ -0,0 +1,121 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include "enn.hpp"
+
+const unsigned numberOfInputNeurons = 16;
+const unsigned numberOfHiddenNeurons = 64;
+const unsigned numberOfOutputNeurons = 4;
+const unsigned numberOfPoints = 512;
+const unsigned numberOfCycles = 100;
+const std::vector<unsigned> throughputLayerSizes {256, 1024, 1024, 16};
+const unsigned numberOfSamples = 1024;
+const unsigned numberOfRepetitions = 3;
+const unsigned seed = 42;
+
+ENN::LearningSet makeSet(unsigned numberOfPoints, unsigned numberOfInputs, unsigned numberOfOutputs)
+{
+	ENN::LearningSet set;
+	
+	for (unsigned p=0 ; p<numberOfPoints ; p++)
+	{
+		ENN::LearningVector inputs(numberOfInputs);
+		ENN::LearningVector outputs(numberOfOutputs);
+		
+		for (float & input : inputs)
+			input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+		
+		for (unsigned i=0 ; i<numberOfOutputs ; i++)
+			outputs[i] = 0.5f * std::sin(3.f * inputs[i] * inputs[(i+4) % numberOfInputs]);
+		
+		set.emplace_back(inputs, outputs);
+	}
+	
+	return set;
+}
+
+//Best time of a few batched passes over the samples, in samples per second
+template <class Model>
+double getThroughput(Model & model, std::vector<float> const & inputs, std::vector<float> & outputs)
+{
+	double best = std::numeric_limits<double>::max();
+	
+	for (unsigned r=0 ; r<numberOfRepetitions ; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		model.processBatch(inputs.data(), numberOfSamples, outputs.data());
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+	
+	return numberOfSamples / best;
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n12 : quantized inference." << std::endl;
+	std::cout << "Kernels: " << ENN::Simd::toString(ENN::Simd::getInstructionSet()) << (ENN::Simd::hasVNNI() ? " with VNNI" : "") << std::endl << std::endl;
+	
+	//Accuracy: a trained regression network, compared on points which were not used for the calibration
+	srand(seed);
+	ENN::NeuralNetwork nn;
+	nn.setSeed(seed);
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+	nn.setLearningRate(0.01f);
+	nn.setBatchSize(8);
+	nn.setMaximumNumberOfCycles(numberOfCycles);
+	nn.appendLearningSet(makeSet(numberOfPoints, numberOfInputNeurons, numberOfOutputNeurons));
+	nn.train();
+	
+	const ENN::LearningSet calibrationSet = makeSet(numberOfPoints, numberOfInputNeurons, numberOfOutputNeurons);
+	const ENN::LearningSet testSet = makeSet(numberOfPoints, numberOfInputNeurons, numberOfOutputNeurons);
+	
+	std::cout << "A trained " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons
+	          << " network is compared with its quantized models on " << testSet.size() << " test points:" << std::endl;
+	
+	for (ENN::QuantizedModel::Precision precision : {ENN::QuantizedModel::Precision::Float16, ENN::QuantizedModel::Precision::Int8})
+	{
+		ENN::QuantizedModel model(nn, precision, calibrationSet);
+		const ENN::QuantizationReport report = model.compare(nn, testSet);
+		
+		std::cout << std::setw(6) << ENN::QuantizedModel::toString(precision) << ": error " << report.quantizedError << " instead of " << report.floatError
+		          << ", output difference " << report.meanDifference << " on average and " << report.maximumDifference << " at most" << std::endl;
+	}
+	
+	//Memory and throughput: a larger network (untrained), calibrated on random inputs
+	ENN::NeuralNetwork large;
+	
+	for (unsigned size : throughputLayerSizes)
+		large.addLayer(size);
+	
+	large.connectAllLayers();
+	large.setFastActivation(true); //Otherwise std::tanh takes most of the time, whatever the precision of the weights
+	
+	const ENN::LearningSet largeCalibrationSet = makeSet(numberOfPoints, throughputLayerSizes.front(), throughputLayerSizes.back());
+	std::vector<float> inputs(numberOfSamples * throughputLayerSizes.front());
+	std::vector<float> outputs(numberOfSamples * throughputLayerSizes.back());
+	
+	for (float & input : inputs)
+		input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+	
+	std::cout << std::endl << "Batched inference of " << numberOfSamples << " samples with a 256x1024x1024x16 network:" << std::endl;
+	
+	const double floatMemory = 4. * (large.getNumberOfWeights());
+	const double floatThroughput = getThroughput(large, inputs, outputs);
+	std::cout << std::setw(6) << "float" << ": " << std::setw(8) << floatMemory / 1e6 << " MB of weights, " << std::setw(8) << floatThroughput << " samples/s" << std::endl;
+	
+	for (ENN::QuantizedModel::Precision precision : {ENN::QuantizedModel::Precision::Float16, ENN::QuantizedModel::Precision::Int8})
+	{
+		ENN::QuantizedModel model(large, precision, largeCalibrationSet);
+		const double throughput = getThroughput(model, inputs, outputs);
+		
+		std::cout << std::setw(6) << ENN::QuantizedModel::toString(precision) << ": " << std::setw(8) << model.getMemorySize() / 1e6 << " MB of weights, " << std::setw(8) << throughput
+		          << " samples/s (x" << throughput / floatThroughput << ")" << std::endl;
+	}
+	
+	return 0;
+}
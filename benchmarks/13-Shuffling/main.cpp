@@ -0,0 +1,110 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "enn.hpp"
+
+const unsigned numberOfInputNeurons = 8;
+const unsigned numberOfHiddenNeurons = 32;
+const unsigned numberOfOutputNeurons = 4;
+const unsigned numberOfPointsPerClass = 256;
+const unsigned numberOfValidationPoints = 256;
+const unsigned numberOfCycles = 10;
+const unsigned batchSize = 4;
+const unsigned seed = 42;
+const float maxDifference = 1e-5f; //Only the rounding of the sums of the gradients may differ between numbers of threads
+
+//Each class is a gaussian cloud around its own center, the learning points are added one class after the other like a sorted data set often is
+ENN::LearningVector randomPoint(unsigned c)
+{
+	ENN::LearningVector inputs(numberOfInputNeurons);
+	
+	for (unsigned i=0 ; i<numberOfInputNeurons ; i++)
+		inputs[i] = (i % numberOfOutputNeurons == c ? 0.3f : -0.1f) + 0.6f * (static_cast<float>(rand()) / RAND_MAX - 0.5f);
+	
+	return inputs;
+}
+
+ENN::LearningVector classOutputs(unsigned c)
+{
+	ENN::LearningVector outputs(numberOfOutputNeurons, 0.f);
+	outputs[c] = 1.f;
+	return outputs;
+}
+
+//Builds the same network, learning set and validation set every time
+void buildNetwork(ENN::NeuralNetwork & nn, bool shuffling, unsigned numberOfThreads)
+{
+	srand(seed);
+	nn.setSeed(seed);
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+	nn.setActivation(2, ENN::Activation::Softmax);
+	nn.setLoss(ENN::Loss::CrossEntropy);
+	nn.setLearningRate(0.05f);
+	nn.setMaximumNumberOfCycles(numberOfCycles);
+	nn.setShuffling(shuffling);
+	nn.setNumberOfThreads(numberOfThreads);
+	nn.setBatchSize(batchSize);
+	
+	for (unsigned c=0 ; c<numberOfOutputNeurons ; c++)
+	{
+		for (unsigned p=0 ; p<numberOfPointsPerClass ; p++)
+			nn.addLearningPoint(randomPoint(c), classOutputs(c));
+	}
+	
+	for (unsigned p=0 ; p<numberOfValidationPoints ; p++)
+		nn.addValidationPoint(randomPoint(p % numberOfOutputNeurons), classOutputs(p % numberOfOutputNeurons));
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n13 : shuffled learning set." << std::endl;
+	std::cout << "A " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons << " classifier is trained with batches of " << batchSize << " points for " << numberOfCycles << " cycles on "
+	          << numberOfPointsPerClass * numberOfOutputNeurons << " learning points sorted by class, visited in their order or shuffled each cycle." << std::endl << std::endl;
+	
+	std::vector<float> weights[2];
+	
+	for (bool shuffling : {false, true})
+	{
+		ENN::NeuralNetwork nn;
+		buildNetwork(nn, shuffling, 1);
+		
+		auto start = std::chrono::steady_clock::now();
+		const unsigned cycles = nn.train();
+		const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / cycles;
+		
+		std::cout << std::setw(12) << std::left << (shuffling ? "Shuffled: " : "In order: ") << "validation error " << nn.getValidationError() << ", " << time << " ms per cycle" << std::endl;
+		
+		weights[0].resize(nn.getNumberOfWeights());
+		nn.getWeights(weights[0].data());
+	}
+	
+	//The same seed gives the same shuffles, whatever the number of threads (only the order of the sums of the gradients changes)
+	{
+		ENN::NeuralNetwork nn;
+		buildNetwork(nn, true, batchSize);
+		nn.train();
+		
+		weights[1].resize(nn.getNumberOfWeights());
+		nn.getWeights(weights[1].data());
+	}
+	
+	float difference = 0.f;
+	for (unsigned w=0 ; w<weights[0].size() ; w++)
+		difference = std::max(difference, std::abs(weights[0][w] - weights[1][w]));
+	
+	std::cout << std::endl << "Largest weight difference between 1 and " << batchSize << " threads with the same seed: " << difference << std::endl;
+	
+	if (!(difference <= maxDifference))
+	{
+		std::cout << "The training is not reproducible whatever the number of threads (difference above " << maxDifference << ")" << std::endl;
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+
+#include "enn.hpp"
+
+const unsigned numberOfInputNeurons = 16;
+const unsigned numberOfHiddenNeurons = 64;
+const unsigned numberOfOutputNeurons = 4;
+const unsigned numberOfPoints = 1024;
+const unsigned batchSize = 16;
+const unsigned numberOfCycles = 200;
+const float targetError = 2.f;
+const unsigned seed = 42;
+
+//Remembers the first cycle whose error is below targetError
+class TargetObserver : public ENN::TrainingObserver
+{
+	public:
+
+		TargetObserver() : _cycle(0), _error(0.f), _reached(false) {}
+
+		void onCycleEnd(ENN::TrainingStatistics const & statistics) override
+		{
+			_error = statistics.error;
+
+			if (!_reached && statistics.error < targetError)
+			{
+				_reached = true;
+				_cycle = statistics.cycle + 1;
+			}
+		}
+
+		unsigned getCycle() const { return _cycle; }
+		float getError() const { return _error; }
+		bool hasReached() const { return _reached; }
+
+	private:
+
+		unsigned _cycle;
+		float _error;
+		bool _reached;
+};
+
+//Builds the same network and learning set every time
+void buildNetwork(ENN::NeuralNetwork & nn)
+{
+	srand(seed);
+	nn.setSeed(seed);
+	nn.addLayer(numberOfInputNeurons);
+	nn.addLayer(numberOfHiddenNeurons);
+	nn.addLayer(numberOfOutputNeurons);
+	nn.connectAllLayers();
+	nn.setBatchSize(batchSize);
+	nn.setMaximumNumberOfCycles(numberOfCycles);
+	
+	for (unsigned p=0 ; p<numberOfPoints ; p++)
+	{
+		ENN::LearningVector inputs(numberOfInputNeurons);
+		ENN::LearningVector outputs(numberOfOutputNeurons);
+		
+		for (float & input : inputs)
+			input = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+		
+		for (unsigned i=0 ; i<numberOfOutputNeurons ; i++)
+			outputs[i] = 0.5f * std::sin(3.f * (inputs[i] + inputs[i+4])) + 0.3f * inputs[i+8];
+		
+		nn.addLearningPoint(inputs, outputs);
+	}
+}
+
+void run(ENN::Optimizer const & optimizer, float learningRate, std::shared_ptr<ENN::LearningRateSchedule> schedule, std::string const & name)
+{
+	ENN::NeuralNetwork nn;
+	buildNetwork(nn);
+	nn.setOptimizer(optimizer);
+	nn.setLearningRate(learningRate);
+	nn.setLearningRateSchedule(schedule);
+	
+	std::shared_ptr<TargetObserver> observer = std::make_shared<TargetObserver>();
+	nn.addTrainingObserver(observer);
+	
+	auto start = std::chrono::steady_clock::now();
+	const unsigned cycles = nn.train();
+	const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / cycles;
+	
+	std::cout << std::setw(28) << std::left << name << std::setw(12) << observer->getError() << std::setw(14)
+	          << (observer->hasReached() ? std::to_string(observer->getCycle()) : "not reached") << time << std::endl;
+}
+
+int main()
+{
+	std::cout << "ENNlib benchmark n14 : optimizers." << std::endl;
+	std::cout << "A " << numberOfInputNeurons << "x" << numberOfHiddenNeurons << "x" << numberOfOutputNeurons << " network is trained on " << numberOfPoints
+	          << " learning points with batches of " << batchSize << " for " << numberOfCycles << " cycles with each optimizer." << std::endl << std::endl;
+	
+	std::cout << std::setw(28) << std::left << "Optimizer" << std::setw(12) << "Error" << std::setw(14) << "Cycles to " + std::to_string(targetError).substr(0, 3) << "ms per cycle" << std::endl;
+	
+	//Each optimizer with the best of the learning rates 0.001, 0.003, 0.01 and 0.03
+	run(ENN::Optimizer(ENN::Optimizer::Method::SGD), 0.03f, nullptr, "SGD");
+	run(ENN::Optimizer(ENN::Optimizer::Method::Momentum), 0.01f, nullptr, "Momentum");
+	run(ENN::Optimizer(ENN::Optimizer::Method::Nesterov), 0.01f, nullptr, "Nesterov");
+	run(ENN::Optimizer(ENN::Optimizer::Method::RMSProp), 0.003f, nullptr, "RMSProp");
+	run(ENN::Optimizer(ENN::Optimizer::Method::Adam), 0.003f, nullptr, "Adam");
+	run(ENN::Optimizer(ENN::Optimizer::Method::Adam), 0.01f, std::make_shared<ENN::CosineAnnealing>(numberOfCycles, 0.01f, 5), "Adam, cosine annealing");
+	
+	return 0;
+}
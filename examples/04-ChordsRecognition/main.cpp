@@ -3,7 +3,7 @@
 #include <algorithm>
 #include <string>
 #include <sstream>
-#include <fstream>
+#include <memory>
 
 #include "enn.hpp"
 
@@ -87,29 +87,32 @@ ENN::LearningVector parseChordsIntoOutput(std::string const & chord)
 	return outputs;
 }
 	
-ENN::LearningPoint parseLineIntoLearningPoint(std::string const & line)
+bool isValidNotes(std::vector<std::string> const & notes)
 {
-	if (line.find_first_not_of(" \n") != 0) //the line starts with a space or a newline character
+	for (std::string const & note : notes)
 	{
-		#ifdef DEBUG_PARSING
-		std::cout << "The line '" << line << "' is empty." << std::endl;
-		#endif
-		return ENN::LearningPoint();
-	}
-	
-	if (line[0] == '#') //comment
-	{
-		#ifdef DEBUG_PARSING
-		std::cout << "The line '" << line << "' is a comment." << std::endl;
-		#endif
-		return ENN::LearningPoint();
+		if (note.empty() || note.size() > 2 || note.find_first_not_of("0123456789") != std::string::npos || std::stoi(note) >= static_cast<int>(numberOfInputNeurons))
+			return false;
 	}
 	
+	return !notes.empty();
+}
+
+bool isValidChord(std::vector<std::string> const & chord)
+{
+	return chord.size() == 2
+	    && std::find(chordRoots.begin(), chordRoots.end(), chord.front()) != chordRoots.end()
+	    && std::find(chordCompositions.begin(), chordCompositions.end(), chord.back()) != chordCompositions.end();
+}
+
+//Parser given to the learning source, which streams the file and skips empty lines and comments itself
+bool parseLine(std::string const & line, ENN::LearningVector & inputs, ENN::LearningVector & outputs)
+{
 	//Remove spaces
 	std::string lineWithoutSpaces;
 	for (unsigned i=0 ; i<line.size() ; i++)
 	{
-		if (line[i] != ' ')
+		if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
 		{
 			lineWithoutSpaces.push_back(line[i]);
 		}
@@ -119,38 +122,16 @@ ENN::LearningPoint parseLineIntoLearningPoint(std::string const & line)
 	std::cout << "Changed line '" << line << "' into '" << lineWithoutSpaces << "'." << std::endl;
 	#endif
 	
-	//Split the two parts of the line	
+	//Split the two parts of the line, the learning source reports the invalid ones
 	std::vector<std::string> lineParts = split(lineWithoutSpaces, ';');
 	
-	//Parse the parts and return the learning point
-	return std::make_pair(parseNotesIntoInput(lineParts[0]),  parseChordsIntoOutput(lineParts[1]));
-}
-
-ENN::LearningSet parseFileIntoLearningSet(std::string const & fileName)
-{
-	std::ifstream file(fileName);
+	if (lineParts.size() != 2 || !isValidNotes(split(lineParts[0], '-')) || !isValidChord(split(lineParts[1], '_')))
+		return false;
 	
-	if (!file.is_open())
-	{
-		std::cerr << "Cannot open file " << fileName << "\n";
-		exit(EXIT_FAILURE);
-	}
-	
-	ENN::LearningSet result;
-	std::string line;
+	inputs = parseNotesIntoInput(lineParts[0]);
+	outputs = parseChordsIntoOutput(lineParts[1]);
 	
-	while (std::getline(file,line))
-	{
-		ENN::LearningPoint point = parseLineIntoLearningPoint(line);
-		
-		if (!point.first.empty() && !point.second.empty())
-		{
-			result.push_back(point);
-		}
-	}
-	
-	std::cout << "Sucessfully parsed learning set." << std::endl;
-	return result;
+	return true;
 }
 
 //Reverse parsing operation for chord name
@@ -231,10 +212,14 @@ int main()
 	std::cout << "The file will be parsed and used to train the neural network (lines starting with '#' are ignored)." << std::endl;
 	
 	std::cout << std::endl;
-	std::cout << "Parsing file..." << std::endl;
+	//The points are read on a background thread while the network trains, instead of being loaded all at once
+	std::shared_ptr<ENN::TextLearningSource> learningSource = std::make_shared<ENN::TextLearningSource>(learningSetFileName, parseLine);
+	
+	if (!learningSource->isOpen())
+		return EXIT_FAILURE;
 	
-	ENN::LearningSet learningSet = parseFileIntoLearningSet(learningSetFileName);
-	nn.appendLearningSet(learningSet);
+	nn.setLearningSource(learningSource);
+	std::cout << "The learning set will be streamed from the file during the training." << std::endl;
 	
 	//Let's train the neuron network
 	std::cout << "The learning rate is set to " << learningRate << "." << std::endl;
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "general.hpp"
+
+namespace ENN
+{
+
+enum class Activation { Tanh, Sigmoid, ReLU, Linear, Softmax }; ///<activation function of a layer (Softmax is computed over all the neurons of the layer which have inputs)
+enum class Loss { SquaredError, CrossEntropy }; ///<error of the output layer (CrossEntropy needs a Sigmoid or Softmax output layer)
+
+///This namespace holds the activation and loss functions, and the kernels applying them to a whole run of neurons
+namespace Activations
+{
+	/* Each element-wise function is a policy given as a template parameter to the kernels below, so that it is inlined in their loops.
+	 * The derivatives are expressed with the output values computed by the forward pass, which is all the backward pass keeps.
+	 * The enum-based functions choose the kernel once for a whole run of neurons, never once per neuron.
+	 */
+
+	struct TanhFunction
+	{
+		static float apply(float net) { return tanh(net); }
+		static float derivative(float output) { return 1.f - output * output; }
+	};
+
+	struct SigmoidFunction
+	{
+		static float apply(float net) { return 1.f / (1.f + exp(-net)); }
+		static float derivative(float output) { return output * (1.f - output); }
+	};
+
+	struct ReLUFunction
+	{
+		static float apply(float net) { return net > 0.f ? net : 0.f; }
+		static float derivative(float output) { return output > 0.f ? 1.f : 0.f; }
+	};
+
+	struct LinearFunction
+	{
+		static float apply(float net) { return net; }
+		static float derivative(float) { return 1.f; }
+	};
+
+	template <class Function>
+	void activate(float const * nets, float * outputs, unsigned n) ///<outputs[i] = f(nets[i])
+	{
+		for (unsigned i=0 ; i<n ; i++)
+			outputs[i] = Function::apply(nets[i]);
+	}
+
+	template <class Function>
+	void multiplyByDerivative(float const * outputs, float * derivatives, unsigned n) ///<derivatives[i] *= f'(net[i]), computed from outputs[i]
+	{
+		for (unsigned i=0 ; i<n ; i++)
+			derivatives[i] *= Function::derivative(outputs[i]);
+	}
+
+	void activate(Activation activation, float const * nets, float * outputs, unsigned n, bool fast); ///<element-wise activations only, fast computes Tanh and Sigmoid with Simd::tanh
+	void multiplyByDerivative(Activation activation, float const * outputs, float * derivatives, unsigned n); ///<element-wise activations only
+	float activate(Activation activation, float net); ///<element-wise activations only
+	float derivative(Activation activation, float output); ///<element-wise activations only
+
+	void softmax(float const * nets, float * outputs, unsigned const * numberOfInputs, unsigned size, unsigned stride); ///<softmax of the neurons which have inputs, the value of neuron i is at i*stride
+	void multiplyBySoftmaxDerivative(float const * outputs, float * derivatives, unsigned const * numberOfInputs, unsigned size); ///<multiplies the derivatives with respect to the outputs by the jacobian of the softmax
+
+	float getError(Loss loss, Activation activation, float desiredOutput, float output); ///<error of one output neuron
+	bool isCompatible(Loss loss, Activation activation); ///<whether loss can be used with an output layer computed by activation
+
+	std::string toString(Activation activation);
+	std::string toString(Loss loss);
+}
+
+} //namespace ENN
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "general.hpp"
+
+#include <new>
+
+namespace ENN
+{
+
+///This class allocates objects in large blocks which are only freed with the arena, so that creating millions of them costs a few allocations and their addresses never change
+template <class T>
+class Arena
+{
+	public:
+
+		static const unsigned BlockSize = 4096; ///<number of objects per block
+
+		Arena() : _size(0) {} ///<constructor
+		~Arena() { clear(); } ///<destructor
+
+		Arena(Arena const &) = delete;
+		Arena & operator=(Arena const &) = delete;
+
+		template <class... Arguments>
+		T * create(Arguments &&... arguments) ///<constructs a new object at the end of the arena
+		{
+			if (_size == _blocks.size() * BlockSize)
+				_blocks.push_back(static_cast<T *>(::operator new(BlockSize * sizeof(T))));
+
+			T * object = new (&_blocks.back()[_size % BlockSize]) T(std::forward<Arguments>(arguments)...);
+			_size++;
+			return object;
+		}
+
+		void clear() ///<destroys all the objects and frees the blocks
+		{
+			for (unsigned i=0 ; i<_size ; i++)
+				(*this)[i].~T();
+
+			for (T * block : _blocks)
+				::operator delete(block);
+
+			_blocks.clear();
+			_size = 0;
+		}
+
+		unsigned size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		T & operator[](unsigned i) { return _blocks[i / BlockSize][i % BlockSize]; } ///<objects are numbered in their creation order
+		T const & operator[](unsigned i) const { return _blocks[i / BlockSize][i % BlockSize]; }
+		T & back() { return (*this)[_size - 1]; }
+
+		///This class goes through the objects of an arena in their creation order
+		template <class Value, class Owner>
+		class Iterator
+		{
+			public:
+
+				Iterator(Owner * arena, unsigned i) : _arena(arena), _i(i) {} ///<constructor
+
+				Value & operator*() const { return (*_arena)[_i]; }
+				Value * operator->() const { return &(*_arena)[_i]; }
+				Iterator & operator++() { _i++; return *this; }
+				bool operator!=(Iterator const & other) const { return _i != other._i; }
+				bool operator==(Iterator const & other) const { return _i == other._i; }
+
+			private:
+
+				Owner * _arena;
+				unsigned _i;
+		};
+
+		Iterator<T, Arena> begin() { return Iterator<T, Arena>(this, 0); }
+		Iterator<T, Arena> end() { return Iterator<T, Arena>(this, _size); }
+		Iterator<T const, Arena const> begin() const { return Iterator<T const, Arena const>(this, 0); }
+		Iterator<T const, Arena const> end() const { return Iterator<T const, Arena const>(this, _size); }
+
+
+	private:
+
+		std::vector<T *> _blocks;
+		unsigned _size;
+
+};
+
+} //namespace ENN
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "general.hpp"
+#include "learningsource.hpp"
+
+#include <cstdint>
+#include <fstream>
+
+namespace ENN
+{
+
+///This class streams the learning points of a packed binary file (a Header followed by the inputs then outputs of each point, as native floats)
+class BinaryLearningSource : public PrefetchedLearningSource
+{
+	public:
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t byteOrderMark;
+			uint32_t inputSize;
+			uint32_t outputSize;
+			uint64_t numberOfPoints;
+		};
+
+		BinaryLearningSource(std::string const & fileName, unsigned bufferSize = DefaultBufferSize); ///<constructor (check isOpen() afterwards)
+		~BinaryLearningSource(); ///<destructor
+
+		bool isOpen() const;
+		unsigned getInputSize() const;
+		unsigned getOutputSize() const;
+		uint64_t getNumberOfPoints() const;
+
+		static bool convert(LearningSource & source, std::string const & fileName); ///<writes all the learning points of source into a binary file (one point at a time, so the source does not need to fit in memory)
+
+
+	protected:
+
+		void restart() override;
+		bool read(LearningVector & inputs, LearningVector & outputs) override;
+
+
+	private:
+
+		std::ifstream _file;
+		Header _header;
+		uint64_t _numberOfPointsRead;
+
+};
+
+} //namespace ENN
@@ -12,16 +12,20 @@ class Connection
 {
 	public:
 	
-		Connection(Neuron * from = nullptr, Neuron * to = nullptr); ///<constructor
+		Connection(Neuron * from = nullptr, Neuron * to = nullptr, float * weight = nullptr, float * learningRate = nullptr, bool initialize = true); ///<constructor (weight and learningRate point to the storage of the connection, usually inside a layer matrix, which keeps its values if initialize is false, otherwise the weight is null until the network draws it)
 		
-		Neuron * getSource();
-		Neuron * getDestination();
+		Neuron * getSource() const;
+		Neuron * getDestination() const;
 		
 		void setWeight(float weight);
 		float getWeight() const;
 		
 		void setLearningRate(float learningRate);
-		void updateWeight();
+		float getLearningRate() const;
+		void updateWeight(); ///<plain gradient descent step of this connection alone (train() updates all the weights with the optimizer of the network)
+		
+		static constexpr float DefaultLearningRate = 0.001f; ///<learning rate of new connections
+		static float getDefaultLearningRate();
 		
 
 	private:
@@ -29,12 +33,13 @@ class Connection
 		Neuron * _source;
 		Neuron * _destination;
 
-		float _weight;
-		float _learningRate;
-		static float _defaultLearningRate;
+		float * _weight;
+		float * _learningRate;
+		float _storedWeight; //Used when the connection has no external storage
+		float _storedLearningRate;
 
 };
 
-typedef std::shared_ptr<Connection> ConnectionPtr;
+typedef Connection * ConnectionPtr; //Connections belong to the arena of their network, see NeuralNetwork::connect()
 
 } //namespace ENN
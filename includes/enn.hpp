@@ -1,6 +1,21 @@
 #pragma once
 
 #include "general.hpp"
+#include "logger.hpp"
+#include "activation.hpp"
+#include "layer.hpp"
 #include "neuron.hpp"
 #include "connection.hpp"
+#include "modelfile.hpp"
+#include "learningset.hpp"
+#include "learningsource.hpp"
+#include "textlearningsource.hpp"
+#include "binarylearningsource.hpp"
+#include "simd.hpp"
+#include "trainingobserver.hpp"
+#include "optimizer.hpp"
 #include "neuralnetwork.hpp"
+#include "genetictrainer.hpp"
+#include "model.hpp"
+#include "inferencecontext.hpp"
+#include "quantizedmodel.hpp"
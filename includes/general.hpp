@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <algorithm>
 #include <memory>
 #include <list>
 #include <vector>
@@ -11,12 +12,13 @@
 #include <string>
 #include <sstream>
 
-#define ENABLE_DEBUG
-#define ENABLE_OPENMP
+#include "logger.hpp"
 
-#ifdef ENABLE_OPENMP
-#define GLIBCXX_PARALLEL
-#include <parallel/algorithm>
+/* Messages below ENN_LOG_LEVEL are removed at compile time (0: debug, 1: info, 2: warning, 3: error, 4: none), e.g. make LOG_LEVEL=2.
+ * The others are formatted by the calling thread and written asynchronously by the Logger, so logging never waits for the output.
+ */
+#ifndef ENN_LOG_LEVEL
+#define ENN_LOG_LEVEL 0
 #endif
 
 namespace ENN
@@ -29,63 +31,51 @@ extern "C"
 {
 	//debug < info < warning < error < fatal (error_quit)
 	
-	#ifdef ENABLE_DEBUG
-	#define DEBUG_MSG(...)     \
-	{ 	   \
-		do      \
-		{	   \
-			std::cout     \
-			<< "[DEBUG]"		\
-			<< " (" << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << ") "	\
-			<< __VA_ARGS__		\
-			<< "." << std::endl;		\
-		} while( 0 );     \
-	}
-	#else
-	#define DEBUG_MSG(...)
-	#endif
-	
-	#define INFO_MSG(...)    \
-	{     \
-		do     \
-		{    \
-			std::cout      \
-			<< "[INFO]"		\
-			<< " (" << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << ") "	\
-			<< __VA_ARGS__		\
-			<< "." << std::endl;		\
-		} while( 0 );   \
-	}
-
-	#define WARNING_MSG(...)    \
+	#define ENN_LOG(level, prefix, ...)    \
 	{     \
 		do     \
 		{    \
-			std::cout      \
-			<< "[WARNING]"		\
+			std::ostringstream ennLogStream;      \
+			ennLogStream      \
+			<< prefix		\
 			<< " (" << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << ") "	\
 			<< __VA_ARGS__		\
-			<< "." << std::endl;		\
+			<< ".";		\
+			ENN::Logger::getInstance().log(level, ennLogStream.str());		\
 		} while( 0 );   \
 	}
 	
-	#define ERROR_MSG(...)    \
-	{     \
-		do     \
-		{    \
-			std::cout      \
-			<< "[ERROR]"		\
-			<< " (" << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << ") "	\
-			<< __VA_ARGS__		\
-			<< "." << std::endl;		\
-		} while( 0 );   \
-	}
+	#if ENN_LOG_LEVEL <= 0
+	#define DEBUG_MSG(...) ENN_LOG(ENN::LogLevel::Debug, "[DEBUG]", __VA_ARGS__)
+	#else
+	#define DEBUG_MSG(...)
+	#endif
+	
+	#if ENN_LOG_LEVEL <= 1
+	#define INFO_MSG(...) ENN_LOG(ENN::LogLevel::Info, "[INFO]", __VA_ARGS__)
+	#else
+	#define INFO_MSG(...)
+	#endif
+	
+	#if ENN_LOG_LEVEL <= 2
+	#define WARNING_MSG(...) ENN_LOG(ENN::LogLevel::Warning, "[WARNING]", __VA_ARGS__)
+	#else
+	#define WARNING_MSG(...)
+	#endif
+	
+	#if ENN_LOG_LEVEL <= 3
+	#define ERROR_MSG(...) ENN_LOG(ENN::LogLevel::Error, "[ERROR]", __VA_ARGS__)
+	#else
+	#define ERROR_MSG(...)
+	#endif
 
+	//Fatal errors are never removed, and the pending messages are written before exiting
 	#define ERROR_QUIT(...)   \
 	{   \
 		do    \
 		{    \
-			ERROR_MSG(__VA_ARGS__); \
+			ENN_LOG(ENN::LogLevel::Error, "[ERROR]", __VA_ARGS__); \
+			ENN::Logger::getInstance().flush();		\
 			std::cout     \
 			<< "EXITING" << std::endl;		\
 			std::exit(EXIT_FAILURE);	\
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "general.hpp"
+#include "neuralnetwork.hpp"
+#include "threadpool.hpp"
+
+#include <random>
+
+namespace ENN
+{
+
+///This class trains the weights of a network with a genetic algorithm instead of the gradient descent: a population of weight vectors evolves by selection, crossover and mutation
+class GeneticTrainer
+{
+	public:
+
+		GeneticTrainer(NeuralNetwork & network, unsigned seed); ///<constructor, the same seed always gives the same population (whatever the number of threads)
+
+		GeneticTrainer(GeneticTrainer const &) = delete;
+		GeneticTrainer & operator=(GeneticTrainer const &) = delete;
+
+		void setPopulationSize(unsigned populationSize); ///<number of individuals (64 by default), the population is created again when it changes
+		unsigned getPopulationSize() const;
+		void setNumberOfElites(unsigned numberOfElites); ///<best individuals copied unchanged into the next generation (2 by default)
+		void setTournamentSize(unsigned tournamentSize); ///<each parent is the best of this number of individuals drawn at random (3 by default)
+		void setCrossoverRate(float crossoverRate); ///<probability that a child mixes the weights of two parents instead of copying one (0.9 by default)
+		void setMutationRate(float mutationRate); ///<probability that each weight of a child is mutated (0.05 by default)
+		void setMutationStrength(float mutationStrength); ///<standard deviation of the gaussian noise added to a mutated weight (0.1 by default)
+		void setNumberOfThreads(unsigned numberOfThreads); ///<the individuals of a generation are evaluated in parallel
+		unsigned getNumberOfThreads() const;
+
+		float train(unsigned numberOfGenerations, Verbose verbose = Verbose::None); ///<evolves the population on the learning set of the network then copies the best weights into the network, returns the error of the best individual
+		float getBestError() const; ///<error of the best individual of the last evaluated generation
+
+
+	private:
+
+		NeuralNetwork & _network;
+		std::mt19937 _generator;
+		unsigned _populationSize;
+		unsigned _numberOfElites;
+		unsigned _tournamentSize;
+		float _crossoverRate;
+		float _mutationRate;
+		float _mutationStrength;
+		std::unique_ptr<ThreadPool> _threadPool;
+
+		unsigned _numberOfWeights;
+		std::vector<unsigned> _genes; //Positions of the flat weight arrays which are connections, the others stay null
+		std::vector<float> _population; //populationSize x numberOfWeights, one flat weight array per individual
+		std::vector<float> _offspring; //Next generation, same layout
+		std::vector<float> _errors;
+		std::vector<unsigned> _ranking; //Individuals from the best to the worst
+		std::vector< std::vector<LayerValues> > _values; //Batch buffers of each thread
+
+		void initialize();
+		void evaluate();
+		void breed();
+		unsigned selectParent();
+		float drawUniform(); //Uniform in [0, 1)
+		unsigned drawIndex(unsigned n); //Uniform in [0, n)
+		float drawGaussian(); //Standard normal law
+		unsigned drawGap(); //Geometric law of parameter _mutationRate (number of failures before the first success)
+
+};
+
+} //namespace ENN
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "general.hpp"
+#include "model.hpp"
+
+namespace ENN
+{
+
+///This class holds the values computed by one thread processing a shared Model, so that several threads process the same weights without locks (one context per thread)
+class InferenceContext
+{
+	public:
+
+		InferenceContext(std::shared_ptr<Model const> model); ///<constructor, allocates the values of every layer (the buffers of the batched functions are allocated by their first call, no other call allocates memory), the functions of a context whose model is not loaded write nothing
+
+		InferenceContext(InferenceContext const &) = delete;
+		InferenceContext & operator=(InferenceContext const &) = delete;
+
+		void process(float const * inputs, float * outputs); ///<inputs holds getNumberOfInputs() values, outputs getNumberOfOutputs() values (assumes a loaded model, whose sizes are not checked again: nothing is written if the model is not loaded)
+		LearningVector process(LearningVector const & inputs); ///<same as NeuralNetwork::process()
+		void processBatch(float const * inputs, unsigned numberOfSamples, float * outputs); ///<same as NeuralNetwork::processBatch()
+		void processSequences(float const * inputs, unsigned numberOfSequences, unsigned length, float * outputs); ///<same as NeuralNetwork::processSequences()
+
+		std::shared_ptr<Model const> getModel() const;
+
+
+	private:
+
+		std::shared_ptr<Model const> _model; //Kept alive as long as the context uses it
+		NeuralNetwork const & _network;
+		std::vector<LayerValues> _values;
+		std::vector<LayerValues> _batchValues;
+		std::vector<LayerValues> _previousBatchValues;
+
+};
+
+} //namespace ENN
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "general.hpp"
+#include "activation.hpp"
+#include "trainingobserver.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace ENN
+{
+
+class Connection;
+
+///This struct describes a connection between two non adjacent layers, which cannot be stored inside the dense matrices
+struct SkipConnection
+{
+	unsigned sourceLayer;
+	unsigned sourceIndex;
+	unsigned destinationIndex;
+	Connection * connection;
+};
+
+///This struct holds the parameters of a layer in a compiled (contiguous) form
+struct Layer
+{
+	Layer(unsigned numberOfNeurons, unsigned numberOfNeuronsOnPreviousLayer, float * externalWeights = nullptr, float * externalLearningRates = nullptr, uint8_t * externalConnections = nullptr); ///<constructor (the matrices and the connection bitmap are allocated by the layer unless external ones are given, numberOfInputs then counts the bits of the external bitmap)
+	Layer(Layer const &) = delete; //weights, learningRates and connections may point to storage
+	Layer(Layer &&) = default;
+
+	unsigned getNumberOfWeights() const;
+	unsigned getConnectionBitmapSize() const; ///<in bytes
+	bool hasConnection(unsigned k) const; ///<whether the k-th weight of the matrix is a connection
+	void addConnection(unsigned k); ///<marks the k-th weight of the matrix as a connection (numberOfInputs is not updated)
+	unsigned countConnections(unsigned first, unsigned last) const; ///<number of connections among the weights first to last (excluded) of the matrix
+	void makeRecurrent(float * externalWeights = nullptr, float * externalLearningRates = nullptr); ///<adds the recurrent matrix, allocated by the layer (and null) unless external ones are given
+	bool isRecurrent() const;
+	unsigned getNumberOfRecurrentWeights() const; ///<0 unless the layer is recurrent
+	float getFillRatio() const; ///<fraction of the weights of the matrix which are connections
+	void compileSparse(float maximumFillRatio); ///<the layer becomes sparse when its fill ratio is below maximumFillRatio, its sparse indices are then built from connections
+	void addSkipConnection(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationIndex, Connection * connection); ///<adds the connection to skipConnections and to its index (numberOfInputs is not updated)
+	int findSkipConnection(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationIndex) const; ///<position in skipConnections, -1 if there is no such connection
+	static uint64_t getSkipConnectionKey(unsigned sourceIndex, unsigned destinationIndex);
+
+	unsigned size;
+	unsigned previousSize;
+
+	float * weights; ///<row-major (size x previousSize) matrix of the weights coming from the previous layer, 0 where there is no connection
+	float * learningRates; ///<learning rate of each weight of the matrix, 0 where there is no connection so that missing connections never appear
+	std::vector<unsigned> numberOfInputs; ///<number of input connections of each neuron (neurons without inputs are never computed)
+	uint8_t * connections; ///<bitmap telling whether each weight of the matrix is a connection (weight k is bit k % 8 of byte k / 8, the layout of the model files)
+	float * recurrentWeights; ///<row-major (size x size) matrix of the weights coming from the outputs of the layer at the previous time step, nullptr unless the layer is recurrent
+	float * recurrentLearningRates; ///<learning rate of each weight of the recurrent matrix
+	std::vector<SkipConnection> skipConnections; ///<connections coming from a layer which is not the previous one
+	std::vector< std::unordered_map<uint64_t, unsigned> > skipConnectionIndices; ///<position in skipConnections of each connection, by source layer then by getSkipConnectionKey()
+	Activation activation; ///<activation function of the neurons of the layer (Tanh by default)
+	bool sparse; ///<whether the matrix is computed through the sparse indices below instead of the dense kernels (the weights stay in the dense matrix)
+	std::vector<unsigned> rowOffsets; ///<CSR indices (forward pass): the connections coming to neuron i are rowOffsets[i] to rowOffsets[i+1] in columns
+	std::vector<unsigned> columns; ///<source neuron of each connection, whose weight is weights[i * previousSize + columns[k]]
+	std::vector<unsigned> columnOffsets; ///<CSC indices (backward pass): the connections going from neuron j are columnOffsets[j] to columnOffsets[j+1] in rows
+	std::vector<unsigned> rows; ///<destination neuron of each connection, whose weight is weights[rows[k] * previousSize + j]
+
+	private:
+
+		std::vector<float> _storage; //Weights then learning rates, empty when the matrices are external (e.g. mapped from a file)
+		std::vector<float> _recurrentStorage; //Same for the recurrent matrix
+		std::vector<uint8_t> _connectionStorage; //Same for the connection bitmap
+};
+
+///This struct accumulates the derivatives of the error with respect to the weights of a layer
+struct LayerGradients
+{
+	LayerGradients(Layer const & layer); ///<constructor
+
+	std::vector<float> weights; ///<same layout as Layer::weights
+	std::vector<float> skipConnections; ///<same order as Layer::skipConnections
+	std::vector<float> recurrentWeights; ///<same layout as Layer::recurrentWeights
+};
+
+///This struct holds the values computed on a layer for one learning point
+struct LayerValues
+{
+	LayerValues(unsigned numberOfNeurons); ///<constructor
+
+	std::vector<float> netValues;
+	std::vector<float> outputValues;
+	std::vector<float> desiredOutputValues;
+	std::vector<float> derivativesOfErrorToNetValues;
+};
+
+///This struct holds the values and gradients a thread works on, so that several threads can train the same network
+struct Workspace
+{
+	std::vector<LayerValues> values;
+	std::vector<LayerGradients> gradients;
+	TrainingStatistics statistics; ///<phase times and gradient norms of the thread, only measured when training is observed
+};
+
+} //namespace ENN
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "general.hpp"
+
+namespace ENN
+{
+
+typedef std::vector<float> 							LearningVector;
+typedef std::pair<LearningVector, LearningVector> 	LearningPoint;
+typedef std::vector<LearningPoint> 					LearningSet;
+
+///This class stores learning points packed in two contiguous buffers (inputs and outputs, with fixed strides) and visits them through an index array
+class PackedLearningSet
+{
+	public:
+	
+		PackedLearningSet(unsigned inputSize = 0, unsigned outputSize = 0); ///<constructor
+		
+		void setSizes(unsigned inputSize, unsigned outputSize); ///<sets the size of the input and output vectors (clears the set)
+		unsigned getInputSize() const;
+		unsigned getOutputSize() const;
+		
+		unsigned size() const;
+		bool empty() const;
+		void reserve(unsigned numberOfPoints);
+		void clear(); ///<removes the learning points but keeps the memory
+		void add(float const * inputs, float const * outputs); ///<appends a learning point (getInputSize() inputs and getOutputSize() outputs)
+		
+		float const * getInputs(unsigned point) const; ///<inputs of the point-th point in the order of the index array
+		float const * getOutputs(unsigned point) const; ///<outputs of the point-th point in the order of the index array
+		std::vector<unsigned> & getIndices(); ///<order in which the points are visited (identity unless permuted, e.g. to shuffle the set)
+		
+
+	private:
+	
+		unsigned _inputSize;
+		unsigned _outputSize;
+		std::vector<float> _inputs;
+		std::vector<float> _outputs;
+		std::vector<unsigned> _indices;
+		unsigned _numberOfRows; //Points stored in the buffers, whatever the index array holds
+
+};
+
+} //namespace ENN
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "general.hpp"
+#include "learningset.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace ENN
+{
+
+///This class is the interface of everything train() can read learning points from, without holding them all in memory
+class LearningSource
+{
+	public:
+
+		virtual ~LearningSource(); ///<destructor
+
+		virtual void rewind() = 0; ///<goes back to the first learning point (train() calls it before each cycle)
+		virtual bool next(LearningVector & inputs, LearningVector & outputs) = 0; ///<reads the next learning point into inputs and outputs, returns false once all the points have been read
+
+};
+
+///This class reads the learning points ahead of time on a background thread and keeps them in a bounded buffer
+class PrefetchedLearningSource : public LearningSource
+{
+	public:
+
+		static const unsigned DefaultBufferSize = 1024;
+
+		PrefetchedLearningSource(unsigned bufferSize = DefaultBufferSize); ///<constructor, bufferSize is the maximum number of learning points read ahead
+		virtual ~PrefetchedLearningSource(); ///<destructor
+
+		PrefetchedLearningSource(PrefetchedLearningSource const &) = delete;
+		PrefetchedLearningSource & operator=(PrefetchedLearningSource const &) = delete;
+
+		void rewind() override;
+		bool next(LearningVector & inputs, LearningVector & outputs) override;
+
+
+	protected:
+
+		virtual void restart() = 0; ///<goes back to the beginning of the underlying stream (never called while the reader thread runs)
+		virtual bool read(LearningVector & inputs, LearningVector & outputs) = 0; ///<reads the next learning point from the underlying stream, called on the reader thread
+		void stop(); ///<stops the reader thread, derived classes must call it in their destructor before closing their stream
+
+
+	private:
+
+		std::vector<LearningPoint> _buffer; //Ring buffer, the vectors are swapped with the ones of the caller so that nothing is allocated once warmed up
+		unsigned _first;
+		unsigned _count;
+		bool _finished;
+		bool _stopping;
+		std::thread _reader;
+		std::mutex _mutex;
+		std::condition_variable _notEmpty;
+		std::condition_variable _notFull;
+
+		void readAhead();
+
+};
+
+} //namespace ENN
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ringbuffer.hpp"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace ENN
+{
+
+enum class LogLevel { Debug = 0, Info = 1, Warning = 2, Error = 3 };
+
+///This class is the interface of everything the log messages can be written to
+class LogSink
+{
+	public:
+
+		virtual ~LogSink(); ///<destructor
+
+		virtual void write(LogLevel level, std::string const & message) = 0; ///<called on the writer thread of the logger only
+		virtual void flush(); ///<called once the pending messages have been written (does nothing by default)
+
+};
+
+///This class writes the log messages to a stream, one per line (std::cout by default)
+class StreamSink : public LogSink
+{
+	public:
+
+		StreamSink(std::ostream & stream = std::cout); ///<constructor, the stream must outlive the sink
+
+		void write(LogLevel level, std::string const & message) override;
+		void flush() override;
+
+
+	private:
+
+		std::ostream & _stream;
+
+};
+
+///This class collects the messages of the *_MSG macros: they are pushed into a lock-free buffer and written to the sink by a background thread
+class Logger
+{
+	public:
+
+		static const unsigned Capacity = 4096; ///<maximum number of messages waiting to be written
+		static const unsigned WritePeriod = 5; ///<the pending messages are written every WritePeriod ms
+
+		static Logger & getInstance(); ///<the logger (and its thread) is created by the first message
+
+		Logger(Logger const &) = delete;
+		Logger & operator=(Logger const &) = delete;
+
+		void log(LogLevel level, std::string && message); ///<never blocks nor waits for the sink, the message is dropped if the buffer is full
+		void setSink(std::shared_ptr<LogSink> sink); ///<the pending messages are written to the previous sink first, nullptr discards the messages
+		void flush(); ///<writes all the pending messages before returning (blocks the caller)
+		unsigned long getNumberOfDroppedMessages() const;
+
+
+	private:
+
+		struct Record
+		{
+			LogLevel level;
+			std::string message;
+		};
+
+		RingBuffer<Record> _buffer;
+		std::shared_ptr<LogSink> _sink;
+		std::mutex _sinkMutex; //Held while writing, never by the threads which log
+		std::mutex _wakeMutex;
+		std::condition_variable _wake; //Only notified to stop the writer
+		std::atomic<bool> _stopping;
+		std::atomic<unsigned long> _numberOfDroppedMessages;
+		unsigned long _numberOfReportedDrops;
+		std::thread _writer;
+
+		Logger(); //constructor
+		~Logger(); //destructor, writes the pending messages
+
+		void run(); //Loop of the writer thread
+		void write(); //Writes the pending messages, _sinkMutex must be held
+
+};
+
+} //namespace ENN
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "general.hpp"
+#include "neuralnetwork.hpp"
+
+namespace ENN
+{
+
+///This class holds a network whose weights never change any more, so that any number of threads can use it at the same time through their own InferenceContext
+class Model
+{
+	public:
+
+		Model(std::string const & fileName); ///<loads a file written by NeuralNetwork::save(), the matrices are used in place from the mapped file (check isLoaded() afterwards)
+		Model(NeuralNetwork const & network); ///<copies the current weights of network (which can go on training), the matrices are in a single mapping like a loaded file, and the model uses the activation mode of network (see NeuralNetwork::setFastActivation())
+
+		Model(Model const &) = delete;
+		Model & operator=(Model const &) = delete;
+
+		bool isLoaded() const;
+		unsigned getNumberOfInputs() const;
+		unsigned getNumberOfOutputs() const;
+		NeuralNetwork const & getNetwork() const; ///<read-only access to the topology and the weights (the network can only be processed through an InferenceContext)
+
+
+	private:
+
+		friend class InferenceContext;
+
+		NeuralNetwork _network;
+		bool _loaded;
+
+};
+
+} //namespace ENN
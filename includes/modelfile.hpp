@@ -0,0 +1,96 @@
+#pragma once
+
+#include "general.hpp"
+
+#include <cstdint>
+
+namespace ENN
+{
+
+///This namespace describes the binary file format used by NeuralNetwork::save() and NeuralNetwork::load()
+namespace ModelFile
+{
+	/* Layout of a file (native byte order, every section starts on a multiple of Alignment bytes):
+	 *  - Header
+	 *  - the number of neurons of each layer (uint32_t)
+	 *  - for each layer but the first: its weight matrix and its learning rate matrix (float, row-major, see Layer)
+	 *    followed by its connection bitmap (one bit per weight, set when the connection exists)
+	 *  - for each layer: the output values of its neurons (only meaningful for bias neurons)
+	 *  - the connections between non adjacent layers (SkipConnectionRecord)
+	 *  - since version 2: the activation function of each layer (uint32_t, see Activation), the loss being stored in the header
+	 *  - since version 3: whether each layer is recurrent (uint32_t), then for each recurrent layer its recurrent weight matrix and learning rate matrix
+	 * The matrices and the bitmaps are used in place by NeuralNetwork::load(), so their layout must stay the one of Layer.
+	 */
+
+	const char Magic[8] = {'E', 'N', 'N', 'M', 'O', 'D', 'E', 'L'};
+	const uint32_t Version = 3; //Version 1 files (tanh layers with the squared error) and version 2 files (no recurrent layers) can still be loaded
+	const uint32_t ByteOrderMark = 0x01020304;
+	const uint64_t Alignment = 64;
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t byteOrderMark;
+		uint32_t numberOfLayers;
+		uint32_t loss; //Loss of the network since version 2 (0 in version 1 files, i.e. SquaredError)
+		uint64_t numberOfSkipConnections;
+		uint64_t fileSize;
+	};
+
+	struct SkipConnectionRecord
+	{
+		uint32_t sourceLayer;
+		uint32_t sourceIndex;
+		uint32_t destinationLayer;
+		uint32_t destinationIndex;
+		float weight;
+		float learningRate;
+	};
+
+	///Offsets (in bytes from the beginning of the file) of every section, index 0 of the per-layer vectors is unused for the matrices
+	struct Layout
+	{
+		Layout(std::vector<uint32_t> const & layerSizes, uint64_t numberOfSkipConnections, uint32_t version = Version, std::vector<uint32_t> const & recurrentFlags = std::vector<uint32_t>()); ///<constructor (recurrentFlags holds the flag of each layer, no layer is recurrent if it is empty)
+
+		uint64_t layerSizes;
+		std::vector<uint64_t> weights;
+		std::vector<uint64_t> learningRates;
+		std::vector<uint64_t> connections;
+		std::vector<uint64_t> outputValues;
+		uint64_t skipConnections;
+		uint64_t activations; ///<0 before version 2
+		uint64_t recurrentLayers; ///<0 before version 3
+		std::vector<uint64_t> recurrentWeights; ///<0 for the layers which are not recurrent
+		std::vector<uint64_t> recurrentLearningRates;
+		uint64_t fileSize;
+	};
+
+	uint64_t align(uint64_t offset);
+}
+
+///This class maps a whole file in memory with a private mapping: pages are shared with other processes until they are written
+class MappedFile
+{
+	public:
+	
+		MappedFile(std::string const & fileName); ///<constructor (check isOpen() afterwards)
+		MappedFile(std::vector<char> const & contents); ///<maps anonymous memory holding a copy of contents instead of a file, e.g. a network serialized like a model file
+		~MappedFile(); ///<destructor
+		
+		MappedFile(MappedFile const &) = delete;
+		MappedFile & operator=(MappedFile const &) = delete;
+		
+		bool isOpen() const;
+		char * getData() const;
+		std::size_t getSize() const;
+		
+
+	private:
+	
+		char * _data;
+		std::size_t _size;
+
+};
+
+} //namespace ENN
@@ -2,22 +2,36 @@
 
 #include "general.hpp"
 
+#include "layer.hpp"
+#include "arena.hpp"
 #include "neuron.hpp"
 #include "connection.hpp"
+#include "threadpool.hpp"
+#include "modelfile.hpp"
+#include "learningsource.hpp"
+#include "simd.hpp"
+#include "activation.hpp"
+#include "trainingobserver.hpp"
+#include "optimizer.hpp"
+
+#include <atomic>
+#include <random>
 
 namespace ENN
 {
-	
-typedef std::vector<float> 							LearningVector;
-typedef std::pair<LearningVector, LearningVector> 	LearningPoint;
-typedef std::vector<LearningPoint> 					LearningSet;
 
 ///This class
 class NeuralNetwork
 {	
 	public:
 	
+		enum class ParallelMode { Synchronous, Hogwild };
+		enum class StopReason { Converged, MaximumNumberOfCycles, TimeLimit, EarlyStopping, Stopped }; ///<why train() returned
+		
+		static constexpr float DefaultSparseThreshold = 0.05f; ///<below this fill ratio the sparse kernels of a layer are faster than the dense ones for every pass (see benchmark 11)
+	
 		NeuralNetwork();
+		~NeuralNetwork(); ///<destructor, waits for the checkpoint being written
 	
 		void addLayer(unsigned numberOfNeurons);
 		unsigned getNumberOfLayers() const;
@@ -31,33 +45,173 @@ class NeuralNetwork
 		void setConnectionWeight(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationLayer, unsigned destinationIndex, float weight);
 		bool connectionExists(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationLayer, unsigned destinationIndex) const;
 		void connectAllLayers();
+		void setRecurrent(unsigned layer); ///<the neurons of a hidden layer also get the outputs of the whole layer at the previous time step (Elman layer)
+		bool isRecurrent(unsigned layer) const;
+		void setSparseThreshold(float maximumFillRatio); ///<the matrix of a layer whose fill ratio (connections over neurons x neurons of the previous layer) is below maximumFillRatio is computed with sparse kernels (0 to keep every layer dense)
+		bool isSparse(unsigned layer) const; ///<whether the matrix of the layer will be computed with the sparse kernels
 		
 		void addLearningPoint(LearningVector const & inputs, LearningVector const & outputs);
+		void addLearningSequence(std::vector<LearningVector> const & inputs, std::vector<LearningVector> const & outputs); ///<a sequence of learning points whose outputs depend on the previous points (for recurrent networks, points added one by one are sequences of length 1)
 		void clearLearningSet();
 		void appendLearningSet(LearningSet const & set);
+		void setLearningSource(std::shared_ptr<LearningSource> source); ///<train() then reads the learning points from source, one chunk at a time, instead of the learning set (nullptr to go back to the learning set)
+		void setShuffling(bool enabled); ///<train() visits the learning points in a new random order each cycle (the sequences of a recurrent network stay whole, only their order changes), the points are not copied (false by default)
+		bool getShuffling() const;
+		void setSeed(unsigned seed); ///<seeds the random generator of the network, which draws the weights of the new connections and the order of the learning points (seeded with std::random_device by default)
 		void setLearningRate(float learningRate);
-		unsigned train(Verbose verbose = Verbose::None);
+		void setOptimizer(Optimizer const & optimizer); ///<how train() updates the weights from the gradients (plain gradient descent by default), the state of the optimizer starts from zero at each call to train()
+		Optimizer const & getOptimizer() const;
+		void setLearningRateSchedule(std::shared_ptr<LearningRateSchedule> schedule); ///<during each cycle of train() the learning rates of the connections are multiplied by the factor of the schedule (nullptr, the default, for constant learning rates)
+		void setBatchSize(unsigned batchSize); ///<number of learning points whose gradients are summed before each weight update (1 for online training)
+		unsigned getBatchSize() const;
+		void setNumberOfThreads(unsigned numberOfThreads); ///<each batch is split between the threads, so the batch size should be a multiple of the number of threads
+		unsigned getNumberOfThreads() const;
+		void setParallelMode(ParallelMode mode); ///<Hogwild: each thread trains online on its own part of the learning set and updates the weights without locks (the batch size is ignored, and with a learning source each chunk is shared between the threads)
+		ParallelMode getParallelMode() const;
+		void setActivation(unsigned layer, Activation activation); ///<activation function of the neurons of a layer (Tanh by default)
+		Activation getActivation(unsigned layer) const;
+		void setLoss(Loss loss); ///<error minimized by train() (SquaredError by default)
+		Loss getLoss() const;
+		void setFastActivation(bool enabled); ///<computes tanh and sigmoid with a vectorized approximation (see Simd::tanh) instead of std::tanh
+		bool getFastActivation() const;
+		void setTruncationLength(unsigned truncationLength); ///<recurrent networks are trained with backpropagation through time over windows of this number of time steps (0, the default, for the whole sequences)
+		unsigned getTruncationLength() const;
+		void addTrainingObserver(std::shared_ptr<TrainingObserver> observer); ///<the observer is notified after each cycle of train(), the statistics are only measured while observers are attached
+		void removeTrainingObserver(std::shared_ptr<TrainingObserver> const & observer);
+		void setMaximumNumberOfCycles(unsigned maximumNumberOfCycles); ///<train() stops after this number of cycles (0, the default, for no limit)
+		void setTimeLimit(double seconds); ///<train() stops at the end of the first cycle which ends after this wall time (0, the default, for no limit)
+		void addValidationPoint(LearningVector const & inputs, LearningVector const & outputs); ///<the validation points are never trained on, their error is computed after each cycle with batched inference
+		void clearValidationSet();
+		void setValidationSplit(float fraction); ///<without validation points, train() holds out this fraction of the learning set (its last points) as the validation set (0 by default)
+		void setPatience(unsigned numberOfCycles); ///<train() stops once the validation error (the training error without validation set) did not improve for this number of cycles, and goes back to the best weights (0, the default, to never stop early)
+		void setCheckpoint(std::string const & fileName, unsigned interval); ///<train() saves the network into fileName (see save()) every interval cycles, the file is written by a background thread, which skips to the newest checkpoint when the disk is slower than the training (an empty name disables the checkpoints)
+		void stopTraining(); ///<makes train() return at the end of the current cycle, can be called from an observer or another thread
+		StopReason getStopReason() const; ///<why the last call to train() returned
+		float getValidationError() const; ///<error on the validation set after the last cycle of train() (of the best cycle after early stopping)
+		static std::string toString(StopReason reason);
+		unsigned train(Verbose verbose = Verbose::None); ///<with recurrent layers, each window of each sequence is one batch (the batch size and the threads are ignored)
 		
 		LearningVector process(LearningVector const & inputs);
+		void processBatch(float const * inputs, unsigned numberOfSamples, float * outputs); ///<inputs is a row-major (numberOfSamples x inputs) matrix, outputs a row-major (numberOfSamples x outputs) matrix
+		void processBatch(std::vector<LearningVector> const & inputs, float * outputs); ///<outputs is a row-major (inputs.size() x outputs) matrix
+		std::vector<LearningVector> processSequence(std::vector<LearningVector> const & inputs); ///<outputs of each time step, starting from a null state
+		void processSequences(float const * inputs, unsigned numberOfSequences, unsigned length, float * outputs); ///<processes numberOfSequences sequences of the same length together, inputs is a (numberOfSequences x length x inputs) array, outputs a (numberOfSequences x length x outputs) array
+		
+		unsigned getNumberOfWeights() const; ///<size of the flat weight arrays of getWeights() and setWeights()
+		void getWeights(float * weights) const; ///<copies the weight matrices of the layers (a null weight where two neurons are not connected), then the weights of the connections between non adjacent layers, then the recurrent matrices
+		void setWeights(float const * weights); ///<reverse of getWeights(), the weights of missing connections are ignored
 		
 		std::string toString() const;
 		
+		bool save(std::string const & fileName) const; ///<saves the topology, the weights, the learning rates, the bias values, the activation functions and the loss (see ModelFile)
+		bool load(std::string const & fileName); ///<loads a file written by save() into a network without layers, the weight matrices and the connection bitmaps are used in place from the mapped file (the Neuron and Connection objects are only created once getNeuron() or toString() is called)
+		
 		
 	private:
 	
-		std::list< std::list<Neuron> > _neurons;
-		std::list<ConnectionPtr> _connections;
-		LearningSet _learningSet;
+		friend class Neuron; //Softmax neurons need the values of their whole layer
+		friend class Model; //Copies the network with serialize()
+		friend class InferenceContext; //Processes its own buffers with the re-entrant versions of process()
+		friend class QuantizedModel; //Reads the compiled layers and measures the values of each layer during the calibration
+		friend class GeneticTrainer; //Evaluates the individuals with getBatchError()
+	
+		std::shared_ptr<MappedFile> _mappedFile; //Kept alive as long as the layers use its matrices
+		mutable std::vector< std::vector<Neuron> > _neurons; //The vector of a layer never grows once created, so the neurons never move (their connection lists are built lazily after load(), see buildConnectionViews())
+		mutable Arena<Connection> _connections; //All the connections, created in blocks so that building a large network only takes a few allocations
+		mutable std::atomic<bool> _connectionViewsBuilt; //False after load() until the per-neuron API is used, the connections between adjacent layers then only exist in the bitmaps of the layers
+		mutable std::mutex _connectionViewsMutex; //Const functions may build the views from several threads (e.g. through a shared Model)
+		std::vector<Layer> _layers; //Compiled weights, _layers[0] is empty since input neurons have no inputs
+		std::vector<LayerValues> _values; //Values of the neurons, the Neuron objects are views onto them
+		std::vector<LayerValues> _batchValues; //Values of a block of samples, neuron-major (value of neuron i for sample s is at i*numberOfSamples + s)
+		std::vector<LayerValues> _previousBatchValues; //Values of the previous time step of a block of sequences
+		std::vector< std::vector<LayerValues> > _timeSteps; //Values of each time step of a truncation window, plus the last step of the previous window, allocated before training
+		std::vector<LayerGradients> _gradients;
+		std::vector<Workspace> _workspaces; //One per thread when training in parallel
+		std::unique_ptr<ThreadPool> _threadPool;
+		PackedLearningSet _learningSet;
+		std::shared_ptr<LearningSource> _learningSource;
+		PackedLearningSet _chunk; //Learning points read from the source
+		std::vector<unsigned> _sequenceLengths; //The learning set is split into sequences of these lengths
+		std::vector<unsigned> _shuffledIndices; //Buffers of the shuffle of the sequences, kept between the cycles
+		std::vector<unsigned> _shuffledSequenceLengths;
+		std::vector<unsigned> _sequenceStarts;
+		std::mt19937 _generator;
+		bool _shuffling;
+		unsigned _truncationLength;
+		std::vector< std::shared_ptr<TrainingObserver> > _observers;
+		TrainingStatistics _statistics; //Counters of the current cycle, only updated when observers are attached
+		unsigned _batchSize;
+		ParallelMode _parallelMode;
+		bool _fastActivation;
+		Loss _loss;
+		unsigned _maximumNumberOfCycles;
+		double _timeLimit;
+		PackedLearningSet _validationSet;
+		float _validationSplit;
+		unsigned _patience;
+		std::string _checkpointFileName;
+		unsigned _checkpointInterval;
+		std::thread _checkpointWriter;
+		std::atomic<bool> _stopRequested;
+		std::mutex _checkpointMutex; //Protects the pending checkpoint and the busy flag
+		std::vector<char> _pendingCheckpoint; //Serialized network waiting for the writer thread
+		bool _checkpointBusy; //Whether the writer thread is running
+		StopReason _stopReason;
+		float _validationError;
+		float _sparseThreshold;
+		bool _sparseLayersOutdated; //Set when the topology changes, the sparse indices are built again before the next computation
+		Optimizer _optimizer;
+		std::shared_ptr<LearningRateSchedule> _learningRateSchedule;
+		std::vector<LayerGradients> _firstStates; //State of the optimizer for each weight, same layout as the gradients (empty when the optimizer does not use it)
+		std::vector<LayerGradients> _secondStates;
+		unsigned _numberOfSteps; //Updates since the beginning of train()
+		float _learningRateFactor; //Factor of the schedule for the current cycle
+		
+		void addLayer(unsigned numberOfNeurons, float * weights, float * learningRates, uint8_t * connections);
+		void buildConnectionViews() const; //Creates the Connection objects of the matrices and the connection lists of the neurons if load() did not
+		void connect(Neuron * source, Neuron * destination, unsigned sourceLayer, unsigned sourceIndex, unsigned destinationLayer, unsigned destinationIndex, bool initialize = true);
 		
-		void connect(Neuron * source, Neuron * destination);
+		bool hasRecurrentLayers() const;
+		float drawWeight(); //Uniform in [-0.5, 0.5)
+		unsigned drawIndex(unsigned n); //Uniform in [0, n)
+		void shuffle(std::vector<unsigned> & indices); //Fisher-Yates shuffle with the generator of the network
+		void shuffleSequences(); //Shuffles the order of the sequences of the learning set, each one stays contiguous in the index array
+		void compileSparseLayers(); //Chooses the dense or sparse kernels of each layer and builds the sparse indices, if the topology changed since the last call
+		float trainCycle(PackedLearningSet const & set, float error, Verbose verbose); //Returns error plus the errors of the learning points
+		float trainSequences(PackedLearningSet const & set, float error, Verbose verbose); //Same with backpropagation through time over the sequences of the learning set
+		float trainBatchInParallel(PackedLearningSet const & set, unsigned first, unsigned last);
+		float trainCycleAsynchronously(PackedLearningSet const & set);
+		bool readChunk();
+		void notifyObservers(unsigned cycle, float error);
+		void writeCheckpoint(); //Serializes the network and hands it to the writer thread
+		void writeCheckpoints(std::string const & fileName); //Body of the writer thread, writes the pending checkpoints until there is none
+		bool serialize(std::vector<char> & buffer) const; //Contents of the file written by save()
+		bool load(std::shared_ptr<MappedFile> file, std::string const & fileName); //Builds the network on top of a mapped model file (fileName is only used in the messages)
+		static bool writeFile(std::string const & fileName, std::vector<char> const & buffer);
+		void addGradientNorm(std::vector<LayerGradients> const & gradients); //Counts one update whose gradients are summed in gradients
+		double getSquaredGradientNorm(std::vector<LayerValues> const & values) const; //Of the gradient of the learning point whose derivatives are in values
 		
-		void setBiasNeurons(float constantValue);
-		void setInputs(LearningVector const & values);
-		void setDesiredOutputs(LearningVector const & values);
-		void computeOutputs();
-		float getError() const;
-		void computeDerivativesOfErrorToNets();
-		void updateWeights();
+		void setBiasNeurons(std::vector<LayerValues> & values, float constantValue) const;
+		void setInputs(std::vector<LayerValues> & values, float const * inputs) const;
+		void setDesiredOutputs(std::vector<LayerValues> & values, float const * outputs) const;
+		void computeOutputs(std::vector<LayerValues> & values, std::vector<LayerValues> const * previous = nullptr) const; //previous holds the values of the previous time step (nullptr at the first one)
+		void prepareBatchValues(std::vector<LayerValues> & values) const;
+		void process(float const * inputs, std::vector<LayerValues> & values) const; //Re-entrant versions of the public functions: the network is only read, values and previous are the buffers of the calling thread
+		void processBatch(float const * inputs, unsigned numberOfSamples, float * outputs, std::vector<LayerValues> & values) const;
+		void processSequences(float const * inputs, unsigned numberOfSequences, unsigned length, float * outputs, std::vector<LayerValues> & values, std::vector<LayerValues> & previous) const;
+		void computeBatchOutputs(std::vector<LayerValues> & values, unsigned numberOfSamples, float const * weights, std::vector<LayerValues> const * previous = nullptr) const; //weights is a flat array (see getWeights()), nullptr for the weights of the network
+		float getBatchError(PackedLearningSet const & set, float const * weights, std::vector<LayerValues> & values) const; //Error on the whole set with batched inference, values are the buffers of the calling thread
+		unsigned getNumberOfMatrixWeights() const;
+		unsigned getNumberOfRecurrentWeights() const;
+		float getError(std::vector<LayerValues> const & values) const;
+		void computeDerivativesOfErrorToNets(std::vector<LayerValues> & values, std::vector<LayerValues> const * next = nullptr) const; //next holds the derivatives of the next time step (nullptr at the last one)
+		void accumulateGradients(std::vector<LayerValues> const & values, std::vector<LayerGradients> & gradients, std::vector<LayerValues> const * previous = nullptr) const;
+		Optimizer::Step nextStep(); //Constants of the next update of the optimizer
+		void updateWeights(std::vector<LayerGradients> & gradients, Optimizer::Step const & step); //Applies and clears the gradients
+		void updateWeights(std::vector<LayerValues> const & values); //Plain gradient descent step straight from the values of one learning point
+		void updateWeights(unsigned slice, unsigned numberOfSlices, Optimizer::Step const & step, double * squaredGradientNorm = nullptr); //Adds the squared norm of the gradient of the slice to squaredGradientNorm if it is given
+		void updateDenseWeights(unsigned layer, unsigned slice, unsigned numberOfSlices, Optimizer::Step const & step, double * squaredGradientNorm);
+		void updateSparseWeights(unsigned layer, unsigned slice, unsigned numberOfSlices, Optimizer::Step const & step, double * squaredGradientNorm);
 
 };
 
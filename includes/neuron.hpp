@@ -1,13 +1,14 @@
 #pragma once
 
 #include "general.hpp"
+#include "layer.hpp"
 
 namespace ENN
 {
 	
 class NeuralNetwork;
 class Connection;
-typedef std::shared_ptr<Connection> ConnectionPtr;
+typedef Connection * ConnectionPtr;
 
 ///This class describes the usual model of a neuron which you can easily modify to suit your needs.
 class Neuron
@@ -16,9 +17,11 @@ class Neuron
 	
 		enum class Type { Input, Output, Hidden, Bias };
 		
-		Neuron(NeuralNetwork * network); ///<constructor
+		Neuron(NeuralNetwork * network, LayerValues & values, unsigned layer, unsigned index); ///<constructor (the neuron is a view onto the values of its layer)
 		
 		Type getType() const;
+		unsigned getLayer() const;
+		unsigned getIndex() const;
 		
 		void addInput(ConnectionPtr connection);
 		void addOutput(ConnectionPtr connection);
@@ -43,16 +46,24 @@ class Neuron
 
 	private:
 
+		friend class NeuralNetwork;
+
 		NeuralNetwork * _network;
+		unsigned _layer;
+		unsigned _index;
+		Type _type; //Cached since it only changes with the topology, see updateType()
 
-		std::list<ConnectionPtr> _inputNeurons;
-		std::list<ConnectionPtr> _outputNeurons;
+		std::vector<ConnectionPtr> _inputNeurons;
+		std::vector<ConnectionPtr> _outputNeurons;
 
-		float _netValue;
-		float _outputValue;
-		float _desiredOutput;
+		float * _netValue;
+		float * _outputValue;
+		float * _desiredOutput;
+		
+		float * _derivativeOfErrorToNetValue;
 		
-		float _derivativeOfErrorToNetValue;
+		void updateType();
+		float getDerivativeOfErrorToOutputValue() const;
 
 };
 
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "general.hpp"
+
+namespace ENN
+{
+
+///This class describes how train() turns the gradients of a batch into a weight update: plain gradient descent, or a method keeping a state per weight (momentum, RMSProp, Adam)
+class Optimizer
+{
+	public:
+
+		enum class Method { SGD, Momentum, Nesterov, RMSProp, Adam };
+
+		///This struct holds the constants of one update, computed once for all the weights
+		struct Step
+		{
+			float scale; ///<factor of the learning rates (learning rate schedule, and bias correction with Adam)
+			float epsilon; ///<added to the root mean square of the gradients (scaled like it with Adam)
+		};
+
+		Optimizer(Method method = Method::SGD); ///<constructor, the hyperparameters have their usual default values (momentum 0.9, decay 0.9 for RMSProp, beta1 0.9 and beta2 0.999 for Adam, epsilon 1e-8)
+
+		Method getMethod() const;
+		void setMomentum(float momentum); ///<Momentum and Nesterov: fraction of the velocity kept from one update to the next
+		float getMomentum() const;
+		void setDecay(float decay); ///<RMSProp: fraction of the mean square of the gradients kept from one update to the next
+		float getDecay() const;
+		void setBetas(float beta1, float beta2); ///<Adam: fractions of the mean and of the mean square of the gradients kept from one update to the next
+		float getBeta1() const;
+		float getBeta2() const;
+		void setEpsilon(float epsilon); ///<RMSProp and Adam: keeps the steps finite where the gradients are null
+		float getEpsilon() const;
+
+		unsigned getNumberOfStates() const; ///<number of values the method keeps per weight (0 for SGD, 1 for Momentum, Nesterov and RMSProp, 2 for Adam)
+		Step getStep(unsigned step, float learningRateFactor) const; ///<constants of the step-th update (from 1), the learning rates are multiplied by learningRateFactor
+		void update(Step const & step, float * weights, float const * learningRates, float * gradients, float * firstStates, float * secondStates, unsigned n) const; ///<updates n weights and their states in one vectorized pass, and clears their gradients (the state arrays the method does not use may be nullptr)
+
+		static std::string toString(Method method);
+
+
+	private:
+
+		Method _method;
+		float _momentum;
+		float _decay;
+		float _beta1;
+		float _beta2;
+		float _epsilon;
+
+};
+
+///This class is the interface of everything that changes the learning rates during the training, see NeuralNetwork::setLearningRateSchedule()
+class LearningRateSchedule
+{
+	public:
+
+		virtual ~LearningRateSchedule(); ///<destructor
+
+		virtual float getFactor(unsigned cycle) const = 0; ///<the learning rates of the connections are multiplied by this factor during the cycle-th cycle of train() (from 0)
+};
+
+///This class multiplies the learning rates by factor every interval cycles
+class StepDecay : public LearningRateSchedule
+{
+	public:
+
+		StepDecay(unsigned interval, float factor = 0.5f); ///<constructor, the learning rates are multiplied by factor every interval cycles
+
+		float getFactor(unsigned cycle) const override;
+
+
+	private:
+
+		unsigned _interval;
+		float _factor;
+
+};
+
+///This class multiplies the learning rates by the same factor after each cycle
+class ExponentialDecay : public LearningRateSchedule
+{
+	public:
+
+		ExponentialDecay(float factor); ///<constructor
+
+		float getFactor(unsigned cycle) const override;
+
+
+	private:
+
+		float _factor;
+
+};
+
+///This class makes the learning rates go down from their value to minimumFactor times their value along half a cosine, after a linear warm-up
+class CosineAnnealing : public LearningRateSchedule
+{
+	public:
+
+		CosineAnnealing(unsigned numberOfCycles, float minimumFactor = 0.f, unsigned warmUpCycles = 0); ///<constructor, the learning rates grow linearly during the warm-up cycles, then reach their minimum numberOfCycles cycles after the beginning (warm-up included) and stay there
+
+		float getFactor(unsigned cycle) const override;
+
+
+	private:
+
+		unsigned _numberOfCycles;
+		float _minimumFactor;
+		unsigned _warmUpCycles;
+
+};
+
+} //namespace ENN
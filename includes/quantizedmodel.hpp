@@ -0,0 +1,85 @@
+#pragma once
+
+#include "general.hpp"
+#include "neuralnetwork.hpp"
+
+#include <cstdint>
+
+namespace ENN
+{
+
+///This struct compares the outputs of a quantized model with the ones of the float network it was made from
+struct QuantizationReport
+{
+	QuantizationReport(); ///<constructor
+
+	unsigned numberOfPoints;
+	float maximumDifference; ///<largest absolute difference between an output of the model and the same output of the network
+	float meanDifference; ///<mean absolute difference over all the outputs
+	float floatError; ///<error of the network on the points (summed like the training error, with the loss of the network)
+	float quantizedError; ///<error of the model on the same points
+};
+
+///This class is a trained feed forward network whose weights are stored with fewer bits (int8 or half-precision floats), for inference only
+class QuantizedModel
+{
+	public:
+
+		enum class Precision { Int8, Float16 };
+
+		QuantizedModel(NeuralNetwork & network, Precision precision, LearningSet const & calibrationSet = LearningSet()); ///<Int8: one scale per weight matrix, and one scale per layer for its values, measured on the calibration set (required). Recurrent networks cannot be quantized (check isQuantized() afterwards)
+
+		QuantizedModel(QuantizedModel const &) = delete;
+		QuantizedModel & operator=(QuantizedModel const &) = delete;
+
+		bool isQuantized() const;
+		Precision getPrecision() const;
+		std::size_t getMemorySize() const; ///<bytes taken by the weight matrices (4 bytes per weight in the float network, plus as much for the learning rates)
+
+		LearningVector process(LearningVector const & inputs);
+		void processBatch(float const * inputs, unsigned numberOfSamples, float * outputs); ///<same layout as NeuralNetwork::processBatch()
+		QuantizationReport compare(NeuralNetwork & network, LearningSet const & set); ///<accuracy drop against the network the model was made from, on set
+
+		static std::string toString(Precision precision);
+
+
+	private:
+
+		struct QuantizedSkipConnection
+		{
+			unsigned sourceLayer;
+			unsigned sourceIndex;
+			unsigned destinationIndex;
+			float weight;
+		};
+
+		//Weights of a layer, the values of its neurons without inputs and its connections coming from non adjacent layers
+		struct QuantizedLayer
+		{
+			unsigned size;
+			unsigned previousSize;
+			Activation activation;
+			std::vector<int8_t> weights; //Int8, row-major like Layer::weights
+			std::vector<uint16_t> halfWeights; //Float16, same layout
+			float scale; //Int8: the net value of a neuron is scale times the integer dot product of its row and of the quantized inputs
+			float inputScale; //Int8: the outputs of the previous layer are quantized as round(output / inputScale)
+			std::vector<unsigned> numberOfInputs;
+			std::vector<float> biasValues; //Output of the neurons without inputs
+			std::vector<QuantizedSkipConnection> skipConnections; //Kept in float
+		};
+
+		std::vector<QuantizedLayer> _layers;
+		Precision _precision;
+		bool _quantized;
+		Loss _loss;
+		bool _fastActivation;
+
+		std::vector< std::vector<float> > _values; //Outputs of each layer for a block of samples, sample-major (value of neuron i for sample s is at s*size + i)
+		std::vector<int8_t> _quantizedInputs; //Outputs of the previous layer for a block of samples, quantized
+		std::vector<float> _row; //Row of a half-precision matrix converted to floats
+
+		void computeLayer(unsigned l, float const * inputs, unsigned numberOfSamples);
+
+};
+
+} //namespace ENN
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace ENN
+{
+
+///This class is a bounded queue which any number of threads can push into without locks (the pops must not run concurrently)
+template <class T>
+class RingBuffer
+{
+	public:
+
+		RingBuffer(std::size_t capacity) ///<constructor, the capacity is rounded up to a power of 2
+		 : _mask(getPowerOfTwo(capacity) - 1), _cells(new Cell[_mask + 1]), _pushPosition(0), _popPosition(0)
+		{
+			for (std::size_t i=0 ; i<=_mask ; i++)
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		RingBuffer(RingBuffer const &) = delete;
+		RingBuffer & operator=(RingBuffer const &) = delete;
+
+		bool push(T && value) ///<returns false without waiting when the buffer is full
+		{
+			/* Each cell has a sequence number telling whose turn it is: pushPosition when it can be written, pushPosition+1 once written.
+			 * A producer reserves a cell by moving the push position forward with a compare and swap, then publishes it with its sequence number.
+			 */
+			std::size_t position = _pushPosition.load(std::memory_order_relaxed);
+			Cell * cell;
+
+			for (;;)
+			{
+				cell = &_cells[position & _mask];
+				const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+				if (difference == 0)
+				{
+					if (_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+				{
+					return false;
+				}
+				else
+				{
+					position = _pushPosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			cell->value = std::move(value);
+			cell->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool pop(T & value) ///<returns false when the buffer is empty
+		{
+			Cell & cell = _cells[_popPosition & _mask];
+
+			if (cell.sequence.load(std::memory_order_acquire) != _popPosition + 1)
+				return false;
+
+			value = std::move(cell.value);
+			cell.sequence.store(_popPosition + _mask + 1, std::memory_order_release);
+			_popPosition++;
+			return true;
+		}
+
+		std::size_t getCapacity() const { return _mask + 1; }
+
+
+	private:
+
+		struct Cell
+		{
+			std::atomic<std::size_t> sequence;
+			T value;
+		};
+
+		static std::size_t getPowerOfTwo(std::size_t n)
+		{
+			std::size_t power = 1;
+			while (power < n)
+				power *= 2;
+
+			return power;
+		}
+
+		const std::size_t _mask;
+		std::unique_ptr<Cell[]> _cells;
+		alignas(64) std::atomic<std::size_t> _pushPosition; //On its own cache line, the producers write it all the time
+		alignas(64) std::size_t _popPosition;
+
+};
+
+} //namespace ENN
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "general.hpp"
+
+#include <cstdint>
+
+namespace ENN
+{
+
+///This namespace holds the vectorized kernels of the dense layers, the best instruction set of the CPU is chosen at runtime (CPUID)
+namespace Simd
+{
+	/* Only dot() changes the order of the operations (several partial sums, fused multiply-add with AVX2 and AVX-512),
+	 * so its result may differ from the scalar kernel: |dot - scalarDot| <= 2 * n * 2^-24 * sum(|a[i] * b[i]|)
+	 * (the usual bound of a sum of n floats, i.e. about 1e-5 relative for 100 terms of the same sign).
+	 * The other kernels do the same operations as the scalar ones in the same order, their results are identical
+	 * (except tanh(), whose error bound does not depend on the instruction set).
+	 */
+
+	enum class InstructionSet { Scalar = 0, SSE = 1, AVX2 = 2, AVX512 = 3 };
+
+	InstructionSet getBestInstructionSet(); ///<best instruction set supported by the CPU
+	InstructionSet getInstructionSet(); ///<instruction set used by the kernels (the best one by default)
+	void setInstructionSet(InstructionSet instructionSet); ///<forces the instruction set (e.g. to compare with the scalar kernels), must not be called while a network is used
+	std::string toString(InstructionSet instructionSet);
+
+	float dot(float const * a, float const * b, unsigned n); ///<returns sum(a[i] * b[i])
+	void axpy(float alpha, float const * x, float * y, unsigned n); ///<y[i] += alpha * x[i]
+	void subtractProduct(float * y, float const * a, float const * b, unsigned n); ///<y[i] -= a[i] * b[i]
+	void subtractScaledProduct(float * y, float const * a, float alpha, float const * b, unsigned n); ///<y[i] -= a[i] * (alpha * b[i])
+	void tanh(float const * x, float * y, unsigned n); ///<y[i] = tanh(x[i]) with a rational approximation (max absolute error below 5e-7, x and y may be the same array)
+
+	//Kernels of the optimizers (see Optimizer): w are the weights, r their learning rates, g their gradients (cleared by the kernel), the other arrays the state of the optimizer
+	void momentum(float * w, float const * r, float * g, float * v, float momentum, float gradientFactor, float velocityFactor, float scale, unsigned n); ///<v[i] = momentum * v[i] + g[i], w[i] -= r[i] * (scale * (gradientFactor * g[i] + velocityFactor * v[i]))
+	void rmsProp(float * w, float const * r, float * g, float * s, float decay, float epsilon, float scale, unsigned n); ///<s[i] = decay * s[i] + (1 - decay) * g[i]^2, w[i] -= r[i] * (scale * g[i] / (sqrt(s[i]) + epsilon))
+	void adam(float * w, float const * r, float * g, float * m, float * s, float beta1, float beta2, float epsilon, float scale, unsigned n); ///<m[i] = beta1 * m[i] + (1 - beta1) * g[i], s[i] = beta2 * s[i] + (1 - beta2) * g[i]^2, w[i] -= r[i] * (scale * m[i] / (sqrt(s[i]) + epsilon))
+
+	//Kernels of the quantized models (see QuantizedModel)
+	bool hasVNNI(); ///<whether the CPU has the AVX-512 VNNI instructions, used by the int8 dot product with the AVX-512 instruction set
+	int32_t dot(int8_t const * a, int8_t const * b, unsigned n); ///<returns sum(a[i] * b[i]) exactly, the values must be in [-127, 127]
+	void toHalf(float const * x, uint16_t * y, unsigned n); ///<converts to IEEE half-precision floats (rounded to nearest even)
+	void fromHalf(uint16_t const * x, float * y, unsigned n); ///<converts IEEE half-precision floats back (exactly)
+}
+
+} //namespace ENN
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "general.hpp"
+#include "learningsource.hpp"
+
+#include <fstream>
+#include <functional>
+
+namespace ENN
+{
+
+///This class streams the learning points of a text file, one per line (empty lines and lines starting with '#' are ignored)
+class TextLearningSource : public PrefetchedLearningSource
+{
+	public:
+
+		typedef std::function<bool(std::string const & line, LearningVector & inputs, LearningVector & outputs)> Parser; ///<reads one line into inputs and outputs (e.g. the parsing function of example 04), returns false if the line is invalid
+
+		TextLearningSource(std::string const & fileName, Parser parser = parseNumbers, unsigned bufferSize = DefaultBufferSize); ///<constructor (check isOpen() afterwards)
+		~TextLearningSource(); ///<destructor
+
+		bool isOpen() const;
+
+		static bool parseNumbers(std::string const & line, LearningVector & inputs, LearningVector & outputs); ///<default parser, reads lines such as "0.5 -0.5 1 ; 0.5" (inputs, then outputs after the ';')
+
+
+	protected:
+
+		void restart() override;
+		bool read(LearningVector & inputs, LearningVector & outputs) override;
+
+
+	private:
+
+		std::string _fileName;
+		std::ifstream _file;
+		std::string _line;
+		unsigned _lineNumber;
+		Parser _parser;
+
+};
+
+} //namespace ENN
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "general.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace ENN
+{
+
+///This class keeps a fixed set of worker threads alive so that parallel sections do not pay for thread creation
+class ThreadPool
+{
+	public:
+	
+		ThreadPool(unsigned numberOfThreads); ///<constructor (the calling thread counts as one of the threads)
+		~ThreadPool(); ///<destructor
+		
+		ThreadPool(ThreadPool const &) = delete;
+		ThreadPool & operator=(ThreadPool const &) = delete;
+		
+		unsigned getNumberOfThreads() const;
+		void run(std::function<void(unsigned)> const & task); ///<calls task(thread) on every thread and returns once they are all done
+		
+
+	private:
+	
+		std::vector<std::thread> _workers;
+		std::mutex _mutex;
+		std::condition_variable _taskAvailable;
+		std::condition_variable _taskDone;
+		
+		std::function<void(unsigned)> const * _task;
+		unsigned long _generation;
+		unsigned _remainingWorkers;
+		bool _stopping;
+		
+		void work(unsigned thread);
+
+};
+
+} //namespace ENN
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "general.hpp"
+
+#include <chrono>
+
+namespace ENN
+{
+
+///This struct describes one training cycle (one pass over the learning set), it is only filled when observers are attached to the network
+struct TrainingStatistics
+{
+	TrainingStatistics(); ///<constructor (everything null)
+
+	unsigned cycle; ///<number of the cycle, from 0
+	float error; ///<sum of the errors of the learning points during the cycle
+	float validationError; ///<error on the validation set after the cycle, negative without validation set
+	unsigned numberOfPoints; ///<learning points processed during the cycle
+	unsigned numberOfUpdates; ///<weight updates during the cycle
+	double duration; ///<wall time of the cycle in seconds
+	double pointsPerSecond;
+	double forwardTime; ///<seconds spent computing the outputs and the errors (averaged over the threads when training in parallel)
+	double backwardTime; ///<seconds spent computing the derivatives and the gradients
+	double updateTime; ///<seconds spent updating the weights
+	double gradientNorm; ///<mean over the updates of the L2 norm of the gradient applied to the weights
+};
+
+///This class is the interface of everything that follows the training of a network, see NeuralNetwork::addTrainingObserver()
+class TrainingObserver
+{
+	public:
+
+		virtual ~TrainingObserver(); ///<destructor
+
+		virtual void onTrainingBegin(); ///<called by train() before the first cycle (does nothing by default)
+		virtual void onCycleEnd(TrainingStatistics const & statistics) = 0; ///<called by train() after each cycle, on the calling thread
+		virtual void onTrainingEnd(unsigned numberOfCycles, float error); ///<called by train() once the error stopped decreasing (does nothing by default)
+
+};
+
+///This class measures the time spent in a phase of the training, it only reads the clock when it is enabled
+class PhaseTimer
+{
+	public:
+
+		PhaseTimer(bool enabled) : _enabled(enabled) { restart(); } ///<constructor
+
+		void restart() ///<the next call to stop() measures from now
+		{
+			if (_enabled)
+				_start = std::chrono::steady_clock::now();
+		}
+
+		void stop(double & duration) ///<adds the time elapsed since the last restart() or stop() to duration (in seconds)
+		{
+			if (!_enabled)
+				return;
+
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			duration += std::chrono::duration<double>(now - _start).count();
+			_start = now;
+		}
+
+
+	private:
+
+		bool _enabled;
+		std::chrono::steady_clock::time_point _start;
+
+};
+
+} //namespace ENN
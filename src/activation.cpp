@@ -0,0 +1,178 @@
+#include "activation.hpp"
+#include "simd.hpp"
+
+using namespace ENN;
+
+namespace
+{
+	const float minimumProbability = 1e-7f; //Keeps the logarithms of the cross-entropy finite when an output saturates
+}
+
+void Activations::activate(Activation activation, float const * nets, float * outputs, unsigned n, bool fast)
+{
+	switch (activation)
+	{
+		case Activation::Tanh:
+			if (fast)
+				Simd::tanh(nets, outputs, n);
+			else
+				activate<TanhFunction>(nets, outputs, n);
+			break;
+		case Activation::Sigmoid:
+			if (fast)
+			{
+				//sigmoid(x) = (1 + tanh(x/2)) / 2
+				for (unsigned i=0 ; i<n ; i++)
+					outputs[i] = 0.5f * nets[i];
+
+				Simd::tanh(outputs, outputs, n);
+
+				for (unsigned i=0 ; i<n ; i++)
+					outputs[i] = 0.5f * outputs[i] + 0.5f;
+			}
+			else
+			{
+				activate<SigmoidFunction>(nets, outputs, n);
+			}
+			break;
+		case Activation::ReLU:
+			activate<ReLUFunction>(nets, outputs, n);
+			break;
+		case Activation::Linear:
+			activate<LinearFunction>(nets, outputs, n);
+			break;
+		default:
+			ERROR_MSG("Activation function " << toString(activation) << " is not an element-wise function");
+			break;
+	}
+}
+
+void Activations::multiplyByDerivative(Activation activation, float const * outputs, float * derivatives, unsigned n)
+{
+	switch (activation)
+	{
+		case Activation::Tanh:
+			multiplyByDerivative<TanhFunction>(outputs, derivatives, n);
+			break;
+		case Activation::Sigmoid:
+			multiplyByDerivative<SigmoidFunction>(outputs, derivatives, n);
+			break;
+		case Activation::ReLU:
+			multiplyByDerivative<ReLUFunction>(outputs, derivatives, n);
+			break;
+		case Activation::Linear:
+			break;
+		default:
+			ERROR_MSG("Activation function " << toString(activation) << " is not an element-wise function");
+			break;
+	}
+}
+
+float Activations::activate(Activation activation, float net)
+{
+	float output = 0.f;
+	activate(activation, &net, &output, 1, false);
+	return output;
+}
+
+float Activations::derivative(Activation activation, float output)
+{
+	float derivative = 1.f;
+	multiplyByDerivative(activation, &output, &derivative, 1);
+	return derivative;
+}
+
+void Activations::softmax(float const * nets, float * outputs, unsigned const * numberOfInputs, unsigned size, unsigned stride)
+{
+	//The largest net value is subtracted before the exponentials so that they cannot overflow
+	float maximum = -std::numeric_limits<float>::infinity();
+
+	for (unsigned i=0 ; i<size ; i++)
+	{
+		if (numberOfInputs[i] != 0)
+			maximum = std::max(maximum, nets[i * stride]);
+	}
+
+	float sum = 0.f;
+
+	for (unsigned i=0 ; i<size ; i++)
+	{
+		if (numberOfInputs[i] != 0)
+		{
+			outputs[i * stride] = exp(nets[i * stride] - maximum);
+			sum += outputs[i * stride];
+		}
+	}
+
+	for (unsigned i=0 ; i<size ; i++)
+	{
+		if (numberOfInputs[i] != 0)
+			outputs[i * stride] /= sum;
+	}
+}
+
+void Activations::multiplyBySoftmaxDerivative(float const * outputs, float * derivatives, unsigned const * numberOfInputs, unsigned size)
+{
+	//d(output j)/d(net i) = output j * (delta ij - output i), so each derivative becomes output i * (derivative i - sum(derivative j * output j))
+	float sum = 0.f;
+
+	for (unsigned j=0 ; j<size ; j++)
+	{
+		if (numberOfInputs[j] != 0)
+			sum += derivatives[j] * outputs[j];
+	}
+
+	for (unsigned i=0 ; i<size ; i++)
+	{
+		if (numberOfInputs[i] != 0)
+			derivatives[i] = outputs[i] * (derivatives[i] - sum);
+	}
+}
+
+float Activations::getError(Loss loss, Activation activation, float desiredOutput, float output)
+{
+	if (loss == Loss::SquaredError)
+		return pow(desiredOutput - output, 2) / 2.0;
+
+	const float p = std::max(output, minimumProbability);
+
+	//Binary cross-entropy for independent sigmoid outputs, categorical cross-entropy for softmax outputs
+	if (activation == Activation::Sigmoid)
+		return -desiredOutput * log(p) - (1.f - desiredOutput) * log(std::max(1.f - output, minimumProbability));
+
+	return -desiredOutput * log(p);
+}
+
+bool Activations::isCompatible(Loss loss, Activation activation)
+{
+	//With these pairs the derivative of the error with respect to the net value of an output neuron is simply output - desiredOutput
+	return loss == Loss::SquaredError || activation == Activation::Sigmoid || activation == Activation::Softmax;
+}
+
+std::string Activations::toString(Activation activation)
+{
+	switch (activation)
+	{
+		case Activation::Sigmoid:
+			return "sigmoid";
+		case Activation::ReLU:
+			return "relu";
+		case Activation::Linear:
+			return "linear";
+		case Activation::Softmax:
+			return "softmax";
+		default:
+			return "tanh";
+	}
+}
+
+std::string Activations::toString(Loss loss)
+{
+	switch (loss)
+	{
+		case Loss::CrossEntropy:
+			return "cross-entropy";
+		default:
+			return "squared error";
+	}
+}
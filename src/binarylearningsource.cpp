@@ -0,0 +1,155 @@
+#include "binarylearningsource.hpp"
+
+#include <cstring>
+
+using namespace ENN;
+
+namespace
+{
+	const char Magic[8] = {'E', 'N', 'N', 'L', 'S', 'E', 'T', '\0'};
+	const uint32_t Version = 1;
+	const uint32_t ByteOrderMark = 0x01020304;
+}
+
+BinaryLearningSource::BinaryLearningSource(std::string const & fileName, unsigned bufferSize)
+ : PrefetchedLearningSource(bufferSize), _file(fileName, std::ios::binary), _numberOfPointsRead(0)
+{
+	std::memset(&_header, 0, sizeof(_header));
+
+	if (!_file.is_open())
+	{
+		ERROR_MSG("Cannot open file " << fileName);
+		return;
+	}
+
+	_file.seekg(0, std::ios::end);
+	const uint64_t fileSize = _file.tellg();
+	_file.seekg(0);
+
+	if (!_file.read(reinterpret_cast<char *>(&_header), sizeof(_header)) || std::memcmp(_header.magic, Magic, sizeof(Magic)) != 0)
+	{
+		ERROR_MSG("File " << fileName << " is not a binary learning set");
+		_file.close();
+		return;
+	}
+
+	if (_header.byteOrderMark != ByteOrderMark || _header.version != Version)
+	{
+		ERROR_MSG("Binary learning set " << fileName << " has version " << _header.version << " or a byte order which is not supported");
+		_file.close();
+		return;
+	}
+
+	if (fileSize != sizeof(_header) + _header.numberOfPoints * (_header.inputSize + _header.outputSize) * sizeof(float))
+	{
+		ERROR_MSG("Binary learning set " << fileName << " is truncated or corrupted");
+		_file.close();
+		return;
+	}
+}
+
+BinaryLearningSource::~BinaryLearningSource()
+{
+	stop();
+}
+
+bool BinaryLearningSource::isOpen() const
+{
+	return _file.is_open();
+}
+
+unsigned BinaryLearningSource::getInputSize() const
+{
+	return _header.inputSize;
+}
+
+unsigned BinaryLearningSource::getOutputSize() const
+{
+	return _header.outputSize;
+}
+
+uint64_t BinaryLearningSource::getNumberOfPoints() const
+{
+	return _header.numberOfPoints;
+}
+
+bool BinaryLearningSource::convert(LearningSource & source, std::string const & fileName)
+{
+	std::ofstream file(fileName, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		ERROR_MSG("Cannot open file " << fileName);
+		return false;
+	}
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.byteOrderMark = ByteOrderMark;
+
+	//The header is written again at the end, once the sizes and the number of points are known
+	file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+	LearningVector inputs;
+	LearningVector outputs;
+	source.rewind();
+
+	while (source.next(inputs, outputs))
+	{
+		if (header.numberOfPoints == 0)
+		{
+			header.inputSize = inputs.size();
+			header.outputSize = outputs.size();
+		}
+		else if (inputs.size() != header.inputSize || outputs.size() != header.outputSize)
+		{
+			ERROR_MSG("Learning point " << header.numberOfPoints << " does not have the same size as the first one");
+			return false;
+		}
+
+		file.write(reinterpret_cast<char const *>(inputs.data()), inputs.size() * sizeof(float));
+		file.write(reinterpret_cast<char const *>(outputs.data()), outputs.size() * sizeof(float));
+		header.numberOfPoints++;
+	}
+
+	file.seekp(0);
+	file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+	if (!file.good())
+	{
+		ERROR_MSG("Cannot write file " << fileName);
+		return false;
+	}
+
+	return true;
+}
+
+void BinaryLearningSource::restart()
+{
+	_file.clear();
+	_file.seekg(sizeof(_header));
+	_numberOfPointsRead = 0;
+}
+
+bool BinaryLearningSource::read(LearningVector & inputs, LearningVector & outputs)
+{
+	if (!_file.is_open() || _numberOfPointsRead == _header.numberOfPoints)
+		return false;
+
+	inputs.resize(_header.inputSize);
+	outputs.resize(_header.outputSize);
+
+	_file.read(reinterpret_cast<char *>(inputs.data()), inputs.size() * sizeof(float));
+	_file.read(reinterpret_cast<char *>(outputs.data()), outputs.size() * sizeof(float));
+
+	if (!_file)
+	{
+		ERROR_MSG("Cannot read learning point " << _numberOfPointsRead << " of a binary learning set");
+		return false;
+	}
+
+	_numberOfPointsRead++;
+	return true;
+}
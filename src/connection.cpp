@@ -3,38 +3,52 @@
 
 using namespace ENN;
 
-float Connection::_defaultLearningRate = 0.001; //Default learning rate is set to 0.001.
+constexpr float Connection::DefaultLearningRate;
 
-Connection::Connection(Neuron * from, Neuron * to)
- : _source(from), _destination(to)
+Connection::Connection(Neuron * from, Neuron * to, float * weight, float * learningRate, bool initialize)
+ : _source(from), _destination(to),
+   _weight(weight ? weight : &_storedWeight), _learningRate(learningRate ? learningRate : &_storedLearningRate)
 {
-	_weight = ((float)rand()) / ((float)RAND_MAX) - 0.5f; //Generate random weight between -0.5 and 0.5.
-	_learningRate = _defaultLearningRate;
+	if (!initialize)
+		return;
+	
+	*_weight = 0.f; //The network draws the weight with its own generator, see NeuralNetwork::setSeed()
+	*_learningRate = DefaultLearningRate;
+}
+
+float Connection::getDefaultLearningRate()
+{
+	return DefaultLearningRate;
 }
 
-Neuron * Connection::getSource()
+Neuron * Connection::getSource() const
 {
 	return _source;
 }
 
-Neuron * Connection::getDestination()
+Neuron * Connection::getDestination() const
 {
 	return _destination;
 }
 
 void Connection::setWeight(float weight)
 {
-	_weight = weight;
+	*_weight = weight;
 }
 
 float Connection::getWeight() const
 {
-	return _weight;
+	return *_weight;
 }
 
 void Connection::setLearningRate(float learningRate)
 {
-	_learningRate = learningRate;
+	*_learningRate = learningRate;
+}
+
+float Connection::getLearningRate() const
+{
+	return *_learningRate;
 }
 
 void Connection::updateWeight()
@@ -49,6 +63,6 @@ void Connection::updateWeight()
 	 * Then the only thing left to do is to multiply this product by the learning rate and substract the whole to the weight.
 	 */
 	 
-	 //DEBUG_MSG("Update weight " << _weight << " with variation " << _destination->getDerativeOfErrorToNetValue() *  _source->getOutputValue());
-	 _weight -= _learningRate * (_destination->getDerativeOfErrorToNetValue() *  _source->getOutputValue());
+	 //DEBUG_MSG("Update weight " << *_weight << " with variation " << _destination->getDerativeOfErrorToNetValue() *  _source->getOutputValue());
+	 *_weight -= *_learningRate * (_destination->getDerativeOfErrorToNetValue() *  _source->getOutputValue());
 }
@@ -0,0 +1,293 @@
+#include "genetictrainer.hpp"
+
+using namespace ENN;
+
+GeneticTrainer::GeneticTrainer(NeuralNetwork & network, unsigned seed)
+ : _network(network), _generator(seed), _populationSize(64), _numberOfElites(2), _tournamentSize(3),
+   _crossoverRate(0.9f), _mutationRate(0.05f), _mutationStrength(0.1f), _numberOfWeights(0)
+{
+	_values.resize(1);
+}
+
+void GeneticTrainer::setPopulationSize(unsigned populationSize)
+{
+	if (populationSize < 2)
+	{
+		ERROR_MSG("Population size must be at least 2");
+		return;
+	}
+
+	_populationSize = populationSize;
+	_population.clear();
+}
+
+unsigned GeneticTrainer::getPopulationSize() const
+{
+	return _populationSize;
+}
+
+void GeneticTrainer::setNumberOfElites(unsigned numberOfElites)
+{
+	_numberOfElites = numberOfElites;
+}
+
+void GeneticTrainer::setTournamentSize(unsigned tournamentSize)
+{
+	if (tournamentSize == 0)
+	{
+		ERROR_MSG("Tournament size must be at least 1");
+		return;
+	}
+
+	_tournamentSize = tournamentSize;
+}
+
+void GeneticTrainer::setCrossoverRate(float crossoverRate)
+{
+	_crossoverRate = crossoverRate;
+}
+
+void GeneticTrainer::setMutationRate(float mutationRate)
+{
+	if (mutationRate < 0.f || mutationRate > 1.f)
+	{
+		ERROR_MSG("Mutation rate must be between 0 and 1");
+		return;
+	}
+
+	_mutationRate = mutationRate;
+}
+
+void GeneticTrainer::setMutationStrength(float mutationStrength)
+{
+	_mutationStrength = mutationStrength;
+}
+
+void GeneticTrainer::setNumberOfThreads(unsigned numberOfThreads)
+{
+	if (numberOfThreads == 0)
+	{
+		ERROR_MSG("Number of threads must be at least 1");
+		return;
+	}
+
+	if (numberOfThreads == 1)
+		_threadPool.reset();
+	else
+		_threadPool.reset(new ThreadPool(numberOfThreads));
+
+	_values.clear();
+	_values.resize(numberOfThreads);
+}
+
+unsigned GeneticTrainer::getNumberOfThreads() const
+{
+	return _threadPool ? _threadPool->getNumberOfThreads() : 1;
+}
+
+float GeneticTrainer::train(unsigned numberOfGenerations, Verbose verbose)
+{
+	PackedLearningSet const & set = _network._learningSet;
+
+	if (set.empty() || set.getInputSize() != _network._layers.front().size || set.getOutputSize() != _network._layers.back().size)
+	{
+		ERROR_MSG("The learning set of the network is empty or was built for another number of input or output neurons");
+		return 0.f;
+	}
+
+	if (!Activations::isCompatible(_network._loss, _network._layers.back().activation))
+	{
+		ERROR_MSG("The " << Activations::toString(_network._loss) << " loss cannot be used with a " << Activations::toString(_network._layers.back().activation) << " output layer");
+		return 0.f;
+	}
+
+	if (_network.hasRecurrentLayers())
+	{
+		ERROR_MSG("The genetic algorithm cannot train a recurrent network");
+		return 0.f;
+	}
+
+	_network.setBiasNeurons(_network._values, 1.f);
+	_network.compileSparseLayers();
+
+	//The population is created on the first call, and again if the population size or the topology changed
+	if (_population.size() != static_cast<std::size_t>(_populationSize) * _network.getNumberOfWeights())
+	{
+		initialize();
+		evaluate();
+	}
+
+	for (unsigned generation=0 ; generation<numberOfGenerations ; generation++)
+	{
+		breed();
+		evaluate();
+
+		if (verbose >= Verbose::Medium)
+			DEBUG_MSG("Generation " << generation << ": best error = " << _errors[_ranking.front()] << ", median error = " << _errors[_ranking[_populationSize / 2]]);
+	}
+
+	_network.setWeights(&_population[static_cast<std::size_t>(_ranking.front()) * _numberOfWeights]);
+	return getBestError();
+}
+
+float GeneticTrainer::getBestError() const
+{
+	return _ranking.empty() ? std::numeric_limits<float>::max() : _errors[_ranking.front()];
+}
+
+void GeneticTrainer::initialize()
+{
+	_numberOfWeights = _network.getNumberOfWeights();
+
+	//Only the weights of actual connections are genes, the other positions of the matrices stay null
+	_genes.clear();
+	unsigned offset = 0;
+
+	for (Layer const & layer : _network._layers)
+	{
+		for (unsigned k=0 ; k<layer.getNumberOfWeights() ; k++)
+		{
+			if (layer.hasConnection(k))
+				_genes.push_back(offset + k);
+		}
+
+		offset += layer.getNumberOfWeights();
+	}
+
+	for (; offset<_numberOfWeights ; offset++)
+		_genes.push_back(offset);
+
+	//The first individual is the network itself (so that a trained network can be refined), the others are drawn like new connections
+	_population.assign(static_cast<std::size_t>(_populationSize) * _numberOfWeights, 0.f);
+	_offspring.assign(_population.size(), 0.f);
+	_network.getWeights(_population.data());
+
+	for (unsigned i=1 ; i<_populationSize ; i++)
+	{
+		float * individual = &_population[static_cast<std::size_t>(i) * _numberOfWeights];
+
+		for (unsigned gene : _genes)
+			individual[gene] = drawUniform() - 0.5f;
+	}
+
+	_errors.assign(_populationSize, 0.f);
+	_ranking.resize(_populationSize);
+}
+
+void GeneticTrainer::evaluate()
+{
+	PackedLearningSet const & set = _network._learningSet;
+	const unsigned numberOfThreads = getNumberOfThreads();
+
+	//Each individual is evaluated by one thread with batched inference, the errors do not depend on the number of threads
+	auto task = [&](unsigned thread)
+	{
+		for (unsigned i=thread ; i<_populationSize ; i+=numberOfThreads)
+		{
+			const float error = _network.getBatchError(set, &_population[static_cast<std::size_t>(i) * _numberOfWeights], _values[thread]);
+			_errors[i] = std::isnan(error) ? std::numeric_limits<float>::infinity() : error;
+		}
+	};
+
+	if (_threadPool)
+		_threadPool->run(task);
+	else
+		task(0);
+
+	for (unsigned i=0 ; i<_populationSize ; i++)
+		_ranking[i] = i;
+
+	std::sort(_ranking.begin(), _ranking.end(), [this](unsigned a, unsigned b)
+	{
+		return _errors[a] < _errors[b] || (_errors[a] == _errors[b] && a < b);
+	});
+}
+
+void GeneticTrainer::breed()
+{
+	const unsigned numberOfElites = std::min(_numberOfElites, _populationSize);
+
+	for (unsigned i=0 ; i<_populationSize ; i++)
+	{
+		float * child = &_offspring[static_cast<std::size_t>(i) * _numberOfWeights];
+
+		if (i < numberOfElites)
+		{
+			float const * elite = &_population[static_cast<std::size_t>(_ranking[i]) * _numberOfWeights];
+			std::copy(elite, elite + _numberOfWeights, child);
+			continue;
+		}
+
+		float const * firstParent = &_population[static_cast<std::size_t>(selectParent()) * _numberOfWeights];
+		std::copy(firstParent, firstParent + _numberOfWeights, child);
+
+		//Uniform crossover: each gene comes from either parent, one random number gives the choices for 32 genes
+		if (drawUniform() < _crossoverRate)
+		{
+			float const * secondParent = &_population[static_cast<std::size_t>(selectParent()) * _numberOfWeights];
+			uint32_t choices = 0;
+
+			for (unsigned g=0 ; g<_genes.size() ; g++)
+			{
+				if (g % 32 == 0)
+					choices = _generator();
+
+				if (choices & (1u << (g % 32)))
+					child[_genes[g]] = secondParent[_genes[g]];
+			}
+		}
+
+		//Mutation: the distance between two mutated genes follows a geometric law, so only the mutated genes cost a random number
+		if (_mutationRate > 0.f)
+		{
+			for (std::size_t g=drawGap() ; g<_genes.size() ; g+=1+static_cast<std::size_t>(drawGap()))
+				child[_genes[g]] += _mutationStrength * drawGaussian();
+		}
+	}
+
+	std::swap(_population, _offspring);
+}
+
+unsigned GeneticTrainer::selectParent()
+{
+	//Tournament selection: the best of tournamentSize individuals drawn at random, i.e. the lowest of their ranks
+	unsigned rank = drawIndex(_populationSize);
+
+	for (unsigned t=1 ; t<_tournamentSize ; t++)
+		rank = std::min(rank, drawIndex(_populationSize));
+
+	return _ranking[rank];
+}
+
+/* The random numbers are built from the raw 32-bit output of the generator, which the standard defines, and not with the distributions
+ * of <random>, whose results depend on the standard library: a seed gives the same population everywhere (see NeuralNetwork::drawWeight())
+ */
+
+float GeneticTrainer::drawUniform()
+{
+	return static_cast<float>(_generator() >> 8) / 16777216.f;
+}
+
+unsigned GeneticTrainer::drawIndex(unsigned n)
+{
+	return static_cast<unsigned>((static_cast<uint64_t>(_generator()) * n) >> 32);
+}
+
+float GeneticTrainer::drawGaussian()
+{
+	//Box-Muller transform, 1 - u is in (0, 1] so that its logarithm is finite
+	const float u = 1.f - drawUniform();
+	const float v = drawUniform();
+
+	return std::sqrt(-2.f * std::log(u)) * std::cos(6.28318530717958648f * v);
+}
+
+unsigned GeneticTrainer::drawGap()
+{
+	//Inverse of the cumulative distribution of the geometric law: number of genes skipped before the next mutated one
+	if (_mutationRate >= 1.f)
+		return 0;
+
+	const float gap = std::floor(std::log(1.f - drawUniform()) / std::log1p(-_mutationRate));
+	return gap < static_cast<float>(std::numeric_limits<unsigned>::max()) ? static_cast<unsigned>(gap) : std::numeric_limits<unsigned>::max();
+}
@@ -0,0 +1,73 @@
+#include "inferencecontext.hpp"
+
+using namespace ENN;
+
+InferenceContext::InferenceContext(std::shared_ptr<Model const> model)
+ : _model(model), _network(model->_network)
+{
+	//Every function checks that the model is loaded, without it the context has no values and never writes any output
+	if (!model->isLoaded())
+		ERROR_MSG("The model of an inference context must be loaded");
+
+	//The values of the network hold the values of its bias neurons, the other values are overwritten by each call
+	_values = _network._values;
+}
+
+void InferenceContext::process(float const * inputs, float * outputs)
+{
+	if (!_model->isLoaded())
+	{
+		ERROR_MSG("Cannot process inputs with a model which is not loaded");
+		return;
+	}
+
+	_network.process(inputs, _values);
+
+	std::vector<float> const & outputValues = _values.back().outputValues;
+	std::copy(outputValues.begin(), outputValues.end(), outputs);
+}
+
+LearningVector InferenceContext::process(LearningVector const & inputs)
+{
+	if (!_model->isLoaded())
+	{
+		ERROR_MSG("Cannot process inputs with a model which is not loaded");
+		return LearningVector();
+	}
+
+	if (inputs.size() != _model->getNumberOfInputs())
+	{
+		ERROR_MSG("Input learning vector size (" << inputs.size() << ") and number of input neurons (" << _model->getNumberOfInputs() << ") are not equal");
+		return LearningVector();
+	}
+
+	_network.process(inputs.data(), _values);
+	return _values.back().outputValues;
+}
+
+void InferenceContext::processBatch(float const * inputs, unsigned numberOfSamples, float * outputs)
+{
+	if (!_model->isLoaded())
+	{
+		ERROR_MSG("Cannot process inputs with a model which is not loaded");
+		return;
+	}
+
+	_network.processBatch(inputs, numberOfSamples, outputs, _batchValues);
+}
+
+void InferenceContext::processSequences(float const * inputs, unsigned numberOfSequences, unsigned length, float * outputs)
+{
+	if (!_model->isLoaded())
+	{
+		ERROR_MSG("Cannot process inputs with a model which is not loaded");
+		return;
+	}
+
+	_network.processSequences(inputs, numberOfSequences, length, outputs, _batchValues, _previousBatchValues);
+}
+
+std::shared_ptr<Model const> InferenceContext::getModel() const
+{
+	return _model;
+}
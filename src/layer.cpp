@@ -0,0 +1,196 @@
+#include "layer.hpp"
+
+#include <cstring>
+
+using namespace ENN;
+
+Layer::Layer(unsigned numberOfNeurons, unsigned numberOfNeuronsOnPreviousLayer, float * externalWeights, float * externalLearningRates, uint8_t * externalConnections)
+ : size(numberOfNeurons), previousSize(numberOfNeuronsOnPreviousLayer),
+   weights(externalWeights), learningRates(externalLearningRates),
+   numberOfInputs(numberOfNeurons, 0), connections(externalConnections),
+   recurrentWeights(nullptr), recurrentLearningRates(nullptr), activation(Activation::Tanh), sparse(false)
+{
+	if (weights == nullptr || learningRates == nullptr)
+	{
+		_storage.assign(2 * getNumberOfWeights(), 0.f);
+		weights = _storage.data();
+		learningRates = _storage.data() + getNumberOfWeights();
+	}
+	
+	if (connections == nullptr)
+	{
+		_connectionStorage.assign(getConnectionBitmapSize(), 0);
+		connections = _connectionStorage.data();
+		return;
+	}
+	
+	//One pass over the bitmap, a word at a time, instead of one connect() per connection
+	for (unsigned i=0 ; i<size ; i++)
+		numberOfInputs[i] = countConnections(i * previousSize, (i+1) * previousSize);
+}
+
+unsigned Layer::getNumberOfWeights() const
+{
+	return size * previousSize;
+}
+
+unsigned Layer::getConnectionBitmapSize() const
+{
+	return (getNumberOfWeights() + 7) / 8;
+}
+
+bool Layer::hasConnection(unsigned k) const
+{
+	return connections[k / 8] & (1 << (k % 8));
+}
+
+void Layer::addConnection(unsigned k)
+{
+	connections[k / 8] |= 1 << (k % 8);
+}
+
+unsigned Layer::countConnections(unsigned first, unsigned last) const
+{
+	unsigned count = 0;
+	
+	//The bits before the first whole byte and after the last one are counted one by one
+	for (; first < last && first % 8 != 0 ; first++)
+		count += hasConnection(first);
+	
+	for (; last > first && last % 8 != 0 ; last--)
+		count += hasConnection(last - 1);
+	
+	uint8_t const * byte = connections + first / 8;
+	uint8_t const * end = connections + last / 8;
+	
+	for (; byte + sizeof(uint64_t) <= end ; byte += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, byte, sizeof(word));
+		count += __builtin_popcountll(word);
+	}
+	
+	for (; byte < end ; byte++)
+		count += __builtin_popcount(*byte);
+	
+	return count;
+}
+
+void Layer::makeRecurrent(float * externalWeights, float * externalLearningRates)
+{
+	recurrentWeights = externalWeights;
+	recurrentLearningRates = externalLearningRates;
+	
+	if (recurrentWeights == nullptr || recurrentLearningRates == nullptr)
+	{
+		_recurrentStorage.assign(2 * size * size, 0.f);
+		recurrentWeights = _recurrentStorage.data();
+		recurrentLearningRates = _recurrentStorage.data() + size * size;
+	}
+}
+
+bool Layer::isRecurrent() const
+{
+	return recurrentWeights != nullptr;
+}
+
+unsigned Layer::getNumberOfRecurrentWeights() const
+{
+	return isRecurrent() ? size * size : 0;
+}
+
+float Layer::getFillRatio() const
+{
+	if (getNumberOfWeights() == 0)
+		return 0.f;
+	
+	unsigned numberOfConnections = 0;
+	
+	for (unsigned i=0 ; i<size ; i++)
+		numberOfConnections += numberOfInputs[i];
+	
+	return static_cast<float>(numberOfConnections - skipConnections.size()) / getNumberOfWeights();
+}
+
+void Layer::compileSparse(float maximumFillRatio)
+{
+	sparse = getNumberOfWeights() != 0 && getFillRatio() < maximumFillRatio;
+	
+	rowOffsets.clear();
+	columns.clear();
+	columnOffsets.clear();
+	rows.clear();
+	
+	if (!sparse)
+		return;
+	
+	rowOffsets.reserve(size + 1);
+	rowOffsets.push_back(0);
+	
+	for (unsigned i=0 ; i<size ; i++)
+	{
+		for (unsigned j=0 ; j<previousSize ; j++)
+		{
+			if (hasConnection(i * previousSize + j))
+				columns.push_back(j);
+		}
+		
+		rowOffsets.push_back(columns.size());
+	}
+	
+	//The CSC indices are the transpose: count the connections of each column, then place each row in its column
+	columnOffsets.assign(previousSize + 1, 0);
+	rows.resize(columns.size());
+	
+	for (unsigned column : columns)
+		columnOffsets[column + 1]++;
+	
+	for (unsigned j=0 ; j<previousSize ; j++)
+		columnOffsets[j + 1] += columnOffsets[j];
+	
+	std::vector<unsigned> positions(columnOffsets.begin(), columnOffsets.end() - 1);
+	
+	for (unsigned i=0 ; i<size ; i++)
+	{
+		for (unsigned k=rowOffsets[i] ; k<rowOffsets[i+1] ; k++)
+			rows[positions[columns[k]]++] = i;
+	}
+}
+
+void Layer::addSkipConnection(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationIndex, Connection * connection)
+{
+	if (skipConnectionIndices.size() <= sourceLayer)
+		skipConnectionIndices.resize(sourceLayer + 1);
+	
+	skipConnectionIndices[sourceLayer][getSkipConnectionKey(sourceIndex, destinationIndex)] = skipConnections.size();
+	skipConnections.push_back({sourceLayer, sourceIndex, destinationIndex, connection});
+}
+
+int Layer::findSkipConnection(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationIndex) const
+{
+	if (sourceLayer >= skipConnectionIndices.size())
+		return -1;
+	
+	auto it = skipConnectionIndices[sourceLayer].find(getSkipConnectionKey(sourceIndex, destinationIndex));
+	return it == skipConnectionIndices[sourceLayer].end() ? -1 : static_cast<int>(it->second);
+}
+
+uint64_t Layer::getSkipConnectionKey(unsigned sourceIndex, unsigned destinationIndex)
+{
+	return (static_cast<uint64_t>(sourceIndex) << 32) | destinationIndex;
+}
+
+LayerGradients::LayerGradients(Layer const & layer)
+ : weights(layer.getNumberOfWeights(), 0.f),
+   skipConnections(layer.skipConnections.size(), 0.f),
+   recurrentWeights(layer.getNumberOfRecurrentWeights(), 0.f)
+{
+}
+
+LayerValues::LayerValues(unsigned numberOfNeurons)
+ : netValues(numberOfNeurons, 0.f),
+   outputValues(numberOfNeurons, 0.f),
+   desiredOutputValues(numberOfNeurons, 0.f),
+   derivativesOfErrorToNetValues(numberOfNeurons, 0.f)
+{
+}
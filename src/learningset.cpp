@@ -0,0 +1,73 @@
+#include "learningset.hpp"
+
+using namespace ENN;
+
+PackedLearningSet::PackedLearningSet(unsigned inputSize, unsigned outputSize)
+ : _inputSize(inputSize), _outputSize(outputSize), _numberOfRows(0)
+{
+}
+
+void PackedLearningSet::setSizes(unsigned inputSize, unsigned outputSize)
+{
+	clear();
+	_inputSize = inputSize;
+	_outputSize = outputSize;
+}
+
+unsigned PackedLearningSet::getInputSize() const
+{
+	return _inputSize;
+}
+
+unsigned PackedLearningSet::getOutputSize() const
+{
+	return _outputSize;
+}
+
+unsigned PackedLearningSet::size() const
+{
+	return _indices.size();
+}
+
+bool PackedLearningSet::empty() const
+{
+	return _indices.empty();
+}
+
+void PackedLearningSet::reserve(unsigned numberOfPoints)
+{
+	_inputs.reserve(static_cast<std::size_t>(numberOfPoints) * _inputSize);
+	_outputs.reserve(static_cast<std::size_t>(numberOfPoints) * _outputSize);
+	_indices.reserve(numberOfPoints);
+}
+
+void PackedLearningSet::clear()
+{
+	_inputs.clear();
+	_outputs.clear();
+	_indices.clear();
+	_numberOfRows = 0;
+}
+
+void PackedLearningSet::add(float const * inputs, float const * outputs)
+{
+	_inputs.insert(_inputs.end(), inputs, inputs + _inputSize);
+	_outputs.insert(_outputs.end(), outputs, outputs + _outputSize);
+	//The index array may have been truncated or permuted since, only the stored rows tell where the new point is
+	_indices.push_back(_numberOfRows++);
+}
+
+float const * PackedLearningSet::getInputs(unsigned point) const
+{
+	return _inputs.data() + static_cast<std::size_t>(_indices[point]) * _inputSize;
+}
+
+float const * PackedLearningSet::getOutputs(unsigned point) const
+{
+	return _outputs.data() + static_cast<std::size_t>(_indices[point]) * _outputSize;
+}
+
+std::vector<unsigned> & PackedLearningSet::getIndices()
+{
+	return _indices;
+}
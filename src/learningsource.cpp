@@ -0,0 +1,102 @@
+#include "learningsource.hpp"
+
+using namespace ENN;
+
+LearningSource::~LearningSource()
+{
+}
+
+PrefetchedLearningSource::PrefetchedLearningSource(unsigned bufferSize)
+ : _first(0), _count(0), _finished(false), _stopping(false)
+{
+	if (bufferSize == 0)
+	{
+		WARNING_MSG("A prefetch buffer needs at least one learning point, using one");
+		bufferSize = 1;
+	}
+
+	_buffer.resize(bufferSize);
+}
+
+PrefetchedLearningSource::~PrefetchedLearningSource()
+{
+	stop();
+}
+
+void PrefetchedLearningSource::rewind()
+{
+	stop();
+	restart();
+
+	_first = 0;
+	_count = 0;
+	_finished = false;
+	_reader = std::thread(&PrefetchedLearningSource::readAhead, this);
+}
+
+bool PrefetchedLearningSource::next(LearningVector & inputs, LearningVector & outputs)
+{
+	if (!_reader.joinable()) //Nothing has been read yet
+		rewind();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_notEmpty.wait(lock, [this] { return _count > 0 || _finished; });
+
+	if (_count == 0)
+		return false;
+
+	std::swap(inputs, _buffer[_first].first);
+	std::swap(outputs, _buffer[_first].second);
+	_first = (_first + 1) % _buffer.size();
+	_count--;
+
+	lock.unlock();
+	_notFull.notify_one();
+
+	return true;
+}
+
+void PrefetchedLearningSource::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_notFull.notify_one();
+
+	if (_reader.joinable())
+		_reader.join();
+
+	_stopping = false;
+}
+
+void PrefetchedLearningSource::readAhead()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (true)
+	{
+		_notFull.wait(lock, [this] { return _count < _buffer.size() || _stopping; });
+
+		if (_stopping)
+			return;
+
+		//The slot after the last available point is never touched by next(), so it can be filled without the lock
+		LearningPoint & point = _buffer[(_first + _count) % _buffer.size()];
+
+		lock.unlock();
+		const bool available = read(point.first, point.second);
+		lock.lock();
+
+		if (!available)
+		{
+			_finished = true;
+			_notEmpty.notify_one();
+			return;
+		}
+
+		_count++;
+		_notEmpty.notify_one();
+	}
+}
@@ -0,0 +1,116 @@
+#include "logger.hpp"
+
+#include <chrono>
+
+using namespace ENN;
+
+LogSink::~LogSink()
+{
+}
+
+void LogSink::flush()
+{
+}
+
+StreamSink::StreamSink(std::ostream & stream)
+ : _stream(stream)
+{
+}
+
+void StreamSink::write(LogLevel, std::string const & message)
+{
+	_stream << message << '\n';
+}
+
+void StreamSink::flush()
+{
+	_stream.flush();
+}
+
+Logger & Logger::getInstance()
+{
+	static Logger logger;
+	return logger;
+}
+
+Logger::Logger()
+ : _buffer(Capacity), _sink(std::make_shared<StreamSink>()), _stopping(false), _numberOfDroppedMessages(0), _numberOfReportedDrops(0)
+{
+	_writer = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger()
+{
+	_stopping = true;
+	_wake.notify_one();
+	_writer.join();
+	
+	std::lock_guard<std::mutex> lock(_sinkMutex);
+	write();
+}
+
+void Logger::log(LogLevel level, std::string && message)
+{
+	//The writer is not woken up: even a notification is a system call, it checks the buffer periodically instead
+	if (!_buffer.push({level, std::move(message)}))
+		_numberOfDroppedMessages++;
+}
+
+void Logger::setSink(std::shared_ptr<LogSink> sink)
+{
+	std::lock_guard<std::mutex> lock(_sinkMutex);
+	write();
+	_sink = sink;
+}
+
+void Logger::flush()
+{
+	std::lock_guard<std::mutex> lock(_sinkMutex);
+	write();
+}
+
+unsigned long Logger::getNumberOfDroppedMessages() const
+{
+	return _numberOfDroppedMessages;
+}
+
+void Logger::run()
+{
+	while (!_stopping)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_wakeMutex);
+			_wake.wait_for(lock, std::chrono::milliseconds(WritePeriod));
+		}
+		
+		std::lock_guard<std::mutex> lock(_sinkMutex);
+		write();
+	}
+}
+
+void Logger::write()
+{
+	Record record;
+	bool written = false;
+	
+	while (_buffer.pop(record))
+	{
+		if (_sink)
+			_sink->write(record.level, record.message);
+		
+		written = true;
+	}
+	
+	const unsigned long numberOfDroppedMessages = _numberOfDroppedMessages;
+	
+	if (numberOfDroppedMessages != _numberOfReportedDrops && _sink)
+	{
+		_sink->write(LogLevel::Warning, "[WARNING] (logger) " + std::to_string(numberOfDroppedMessages - _numberOfReportedDrops) + " messages were dropped because the log buffer was full.");
+		_numberOfReportedDrops = numberOfDroppedMessages;
+		written = true;
+	}
+	
+	//The sink is flushed once per batch of messages instead of once per message
+	if (written && _sink)
+		_sink->flush();
+}
@@ -0,0 +1,49 @@
+#include "model.hpp"
+
+using namespace ENN;
+
+Model::Model(std::string const & fileName)
+ : _loaded(false)
+{
+	_loaded = _network.load(fileName);
+}
+
+Model::Model(NeuralNetwork const & network)
+ : _loaded(false)
+{
+	//The network is serialized like a model file then loaded from memory, so that both constructors give the same layout
+	std::vector<char> buffer;
+
+	if (!network.serialize(buffer))
+		return;
+
+	std::shared_ptr<MappedFile> contents = std::make_shared<MappedFile>(buffer);
+
+	if (contents->isOpen())
+	{
+		_loaded = _network.load(contents, "<copy of a network>");
+
+		//The model file does not store the activation mode, the copy computes the same values as the network
+		_network.setFastActivation(network.getFastActivation());
+	}
+}
+
+bool Model::isLoaded() const
+{
+	return _loaded;
+}
+
+unsigned Model::getNumberOfInputs() const
+{
+	return _loaded ? _network.getNumberOfNeuronsOnLayer(0) : 0;
+}
+
+unsigned Model::getNumberOfOutputs() const
+{
+	return _loaded ? _network.getNumberOfNeuronsOnLayer(_network.getNumberOfLayers() - 1) : 0;
+}
+
+NeuralNetwork const & Model::getNetwork() const
+{
+	return _network;
+}
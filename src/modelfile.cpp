@@ -0,0 +1,156 @@
+#include "modelfile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+using namespace ENN;
+
+uint64_t ModelFile::align(uint64_t offset)
+{
+	return (offset + Alignment - 1) / Alignment * Alignment;
+}
+
+ModelFile::Layout::Layout(std::vector<uint32_t> const & layerSizes, uint64_t numberOfSkipConnections, uint32_t version, std::vector<uint32_t> const & recurrentFlags)
+ : weights(layerSizes.size(), 0), learningRates(layerSizes.size(), 0), connections(layerSizes.size(), 0), outputValues(layerSizes.size(), 0),
+   recurrentWeights(layerSizes.size(), 0), recurrentLearningRates(layerSizes.size(), 0)
+{
+	uint64_t offset = align(sizeof(Header));
+	
+	this->layerSizes = offset;
+	offset = align(offset + layerSizes.size() * sizeof(uint32_t));
+	
+	for (unsigned l=1 ; l<layerSizes.size() ; l++)
+	{
+		const uint64_t numberOfWeights = static_cast<uint64_t>(layerSizes[l]) * layerSizes[l-1];
+		
+		weights[l] = offset;
+		offset = align(offset + numberOfWeights * sizeof(float));
+		learningRates[l] = offset;
+		offset = align(offset + numberOfWeights * sizeof(float));
+		connections[l] = offset;
+		offset = align(offset + (numberOfWeights + 7) / 8);
+	}
+	
+	for (unsigned l=0 ; l<layerSizes.size() ; l++)
+	{
+		outputValues[l] = offset;
+		offset = align(offset + layerSizes[l] * sizeof(float));
+	}
+	
+	skipConnections = offset;
+	offset += numberOfSkipConnections * sizeof(SkipConnectionRecord);
+	
+	activations = 0;
+	
+	if (version >= 2)
+	{
+		offset = align(offset);
+		activations = offset;
+		offset += layerSizes.size() * sizeof(uint32_t);
+	}
+	
+	recurrentLayers = 0;
+	
+	if (version >= 3)
+	{
+		offset = align(offset);
+		recurrentLayers = offset;
+		offset += layerSizes.size() * sizeof(uint32_t);
+		
+		for (unsigned l=0 ; l<recurrentFlags.size() && l<layerSizes.size() ; l++)
+		{
+			if (recurrentFlags[l] == 0)
+				continue;
+			
+			const uint64_t numberOfWeights = static_cast<uint64_t>(layerSizes[l]) * layerSizes[l];
+			
+			offset = align(offset);
+			recurrentWeights[l] = offset;
+			offset = align(offset + numberOfWeights * sizeof(float));
+			recurrentLearningRates[l] = offset;
+			offset += numberOfWeights * sizeof(float);
+		}
+	}
+	
+	fileSize = offset;
+}
+
+MappedFile::MappedFile(std::string const & fileName)
+ : _data(nullptr), _size(0)
+{
+	const int file = open(fileName.c_str(), O_RDONLY);
+	
+	if (file < 0)
+	{
+		ERROR_MSG("Cannot open file " << fileName);
+		return;
+	}
+	
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		ERROR_MSG("Cannot get the size of file " << fileName << " or file is empty");
+		close(file);
+		return;
+	}
+	
+	//Private and writable: the pages are shared until someone writes them (copy on write), the file itself is never modified
+	void * data = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+	
+	if (data == MAP_FAILED)
+	{
+		ERROR_MSG("Cannot map file " << fileName << " in memory");
+		return;
+	}
+	
+	_data = static_cast<char *>(data);
+	_size = status.st_size;
+}
+
+MappedFile::MappedFile(std::vector<char> const & contents)
+ : _data(nullptr), _size(0)
+{
+	if (contents.empty())
+	{
+		ERROR_MSG("Cannot map empty contents in memory");
+		return;
+	}
+	
+	//The mapping starts on a page boundary, so the matrices are aligned as they would be in a mapped file
+	void * data = mmap(nullptr, contents.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	
+	if (data == MAP_FAILED)
+	{
+		ERROR_MSG("Cannot map " << contents.size() << " bytes in memory");
+		return;
+	}
+	
+	std::memcpy(data, contents.data(), contents.size());
+	_data = static_cast<char *>(data);
+	_size = contents.size();
+}
+
+MappedFile::~MappedFile()
+{
+	if (_data != nullptr)
+		munmap(_data, _size);
+}
+
+bool MappedFile::isOpen() const
+{
+	return _data != nullptr;
+}
+
+char * MappedFile::getData() const
+{
+	return _data;
+}
+
+std::size_t MappedFile::getSize() const
+{
+	return _size;
+}
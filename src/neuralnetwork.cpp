@@ -1,20 +1,59 @@
 #include "neuralnetwork.hpp"
 
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
 using namespace ENN;
 
+static const unsigned batchBlockSize = 64; //Number of samples processed together by processBatch, small enough to keep the values of a block in cache
+
+//Position of a weight in a state of the optimizer, nullptr when the optimizer does not use this state
+static float * getState(std::vector<LayerGradients> & states, unsigned layer, std::vector<float> LayerGradients::* array, unsigned position)
+{
+	return states.empty() ? nullptr : &(states[layer].*array)[position];
+}
+
+constexpr float NeuralNetwork::DefaultSparseThreshold;
+
 NeuralNetwork::NeuralNetwork()
+ : _connectionViewsBuilt(true), _generator(std::random_device()()), _shuffling(false), _truncationLength(0), _batchSize(1), _parallelMode(ParallelMode::Synchronous), _fastActivation(false), _loss(Loss::SquaredError),
+   _maximumNumberOfCycles(0), _timeLimit(0.), _validationSplit(0.f), _patience(0), _checkpointInterval(0),
+   _stopRequested(false), _checkpointBusy(false), _stopReason(StopReason::Converged), _validationError(0.f),
+   _sparseThreshold(DefaultSparseThreshold), _sparseLayersOutdated(false),
+   _numberOfSteps(0), _learningRateFactor(1.f)
+{
+}
+
+NeuralNetwork::~NeuralNetwork()
 {
-	srand(static_cast<unsigned>(time(0)));
+	if (_checkpointWriter.joinable())
+		_checkpointWriter.join();
 }
 
 void NeuralNetwork::addLayer(unsigned numberOfNeurons)
 {
-	std::list<Neuron> l;
+	addLayer(numberOfNeurons, nullptr, nullptr, nullptr);
+}
+
+void NeuralNetwork::addLayer(unsigned numberOfNeurons, float * weights, float * learningRates, uint8_t * connections)
+{
+	_layers.emplace_back(numberOfNeurons, _layers.empty() ? 0 : _layers.back().size, weights, learningRates, connections);
+	_values.emplace_back(numberOfNeurons);
+	_sparseLayersOutdated = true;
+	
+	_neurons.emplace_back();
+	_neurons.back().reserve(numberOfNeurons);
 	
 	for (unsigned i=0 ; i<numberOfNeurons ; i++)
-		l.emplace_back(this);
+		_neurons.back().emplace_back(this, _values.back(), _layers.size()-1, i);
 	
-	_neurons.push_back(l);
+	//The previous output layer just became a hidden layer
+	if (_neurons.size() > 2)
+	{
+		for (Neuron & neuron : *std::prev(_neurons.end(), 2))
+			neuron.updateType();
+	}
 }
 
 unsigned NeuralNetwork::getNumberOfLayers() const
@@ -30,9 +69,7 @@ unsigned NeuralNetwork::getNumberOfNeuronsOnLayer(unsigned layer) const
 		return 0;
 	}
 	
-	auto it = _neurons.begin();
-	std::advance(it, layer);
-	return it->size();
+	return _neurons[layer].size();
 }
 
 bool NeuralNetwork::neuronExists(unsigned layer, unsigned index) const
@@ -54,13 +91,8 @@ Neuron * NeuralNetwork::getNeuron(unsigned layer, unsigned index)
 		return nullptr;
 	}
 	
-	auto layer_it = _neurons.begin();
-	std::advance(layer_it, layer);
-	
-	auto neuron_it = layer_it->begin();
-	std::advance(neuron_it, index);
-	
-	return &(*neuron_it);
+	buildConnectionViews();
+	return &_neurons[layer][index];
 }
 
 Neuron const * const NeuralNetwork::getNeuron(unsigned layer, unsigned index) const
@@ -71,41 +103,19 @@ Neuron const * const NeuralNetwork::getNeuron(unsigned layer, unsigned index) co
 		return nullptr;
 	}
 	
-	auto layer_it = _neurons.begin();
-	std::advance(layer_it, layer);
-	
-	auto neuron_it = layer_it->begin();
-	std::advance(neuron_it, index);
-	
-	return &(*neuron_it);
+	buildConnectionViews();
+	return &_neurons[layer][index];
 }
 
 std::pair<unsigned, unsigned> NeuralNetwork::getNeuronPosition(Neuron const * const neuron) const
 {
-	unsigned layer = -1, index = -1;
-	bool found = false;
-	
-	for (auto layer_it = _neurons.begin() ; layer_it != _neurons.end() ; layer_it++)
+	if (neuron == nullptr || neuron->_network != this)
 	{
-		if (found)
-			break;
-		
-		for (auto neuron_it = layer_it->begin() ; neuron_it != layer_it->end() ; neuron_it++)
-		{
-			if (neuron == &(*neuron_it))
-			{
-				layer = std::distance(_neurons.begin(), layer_it);
-				index = std::distance(layer_it->begin(), neuron_it);
-				found = true;
-				break;
-			}
-		}
-	}
-	
-	if (!found)
 		WARNING_MSG("Could not find neuron " << neuron << " inside network");
+		return std::make_pair(-1, -1);
+	}
 	
-	return std::make_pair(layer, index);
+	return std::make_pair(neuron->getLayer(), neuron->getIndex());
 }
 
 void NeuralNetwork::connect(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationLayer, unsigned destinationIndex)
@@ -124,7 +134,7 @@ void NeuralNetwork::connect(unsigned sourceLayer, unsigned sourceIndex, unsigned
 
 	if (sourceLayer == destinationLayer)
 	{
-		ERROR_MSG("Cannot connect two neurons on the same layer");
+		ERROR_MSG("Cannot connect two neurons on the same layer (use setRecurrent() to feed a layer with its own previous outputs)");
 		return;
 	}
 
@@ -155,15 +165,85 @@ void NeuralNetwork::connect(unsigned sourceLayer, unsigned sourceIndex, unsigned
 	Neuron * src = getNeuron(sourceLayer, sourceIndex);
 	Neuron * dest = getNeuron(destinationLayer, destinationIndex);
 
-	connect(src, dest);
+	connect(src, dest, sourceLayer, sourceIndex, destinationLayer, destinationIndex);
 }
 
-void NeuralNetwork::connect(Neuron * source, Neuron * destination)
+void NeuralNetwork::connect(Neuron * source, Neuron * destination, unsigned sourceLayer, unsigned sourceIndex, unsigned destinationLayer, unsigned destinationIndex, bool initialize)
 {
-	ConnectionPtr connection = std::make_shared<Connection>(source, destination);
+	//The lists of the neurons must be complete before a connection is added to them
+	buildConnectionViews();
+	
+	Layer & layer = _layers[destinationLayer];
+	ConnectionPtr connection;
+	
+	if (destinationLayer == sourceLayer + 1) //The weight is stored inside the matrix of the destination layer
+	{
+		const unsigned offset = destinationIndex * layer.previousSize + sourceIndex;
+		connection = _connections.create(source, destination, &layer.weights[offset], &layer.learningRates[offset], initialize);
+		layer.addConnection(offset);
+	}
+	else //The connection skips some layers, it keeps its own weight
+	{
+		connection = _connections.create(source, destination, nullptr, nullptr, initialize);
+		layer.addSkipConnection(sourceLayer, sourceIndex, destinationIndex, connection);
+	}
+	
+	if (initialize)
+		connection->setWeight(drawWeight());
+	
+	layer.numberOfInputs[destinationIndex]++;
+	_sparseLayersOutdated = true;
 	source->addOutput(connection);
 	destination->addInput(connection);
-	_connections.push_back(connection);
+}
+
+void NeuralNetwork::buildConnectionViews() const
+{
+	if (_connectionViewsBuilt)
+		return;
+	
+	std::lock_guard<std::mutex> lock(_connectionViewsMutex);
+	
+	if (_connectionViewsBuilt)
+		return;
+	
+	/* Same lists as if load() had called connect() for each bit of the bitmaps, then for each connection between non adjacent layers:
+	 * the inputs of a neuron by increasing source index, its outputs by increasing destination index
+	 */
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		Layer const & layer = _layers[l];
+		
+		for (unsigned i=0 ; i<layer.size ; i++)
+		{
+			Neuron & destination = _neurons[l][i];
+			destination._inputNeurons.reserve(layer.numberOfInputs[i]);
+			
+			for (unsigned j=0 ; j<layer.previousSize ; j++)
+			{
+				const unsigned k = i * layer.previousSize + j;
+				
+				if (!layer.hasConnection(k))
+					continue;
+				
+				Neuron & source = _neurons[l-1][j];
+				ConnectionPtr connection = _connections.create(&source, &destination, &layer.weights[k], &layer.learningRates[k], false);
+				source.addOutput(connection);
+				destination.addInput(connection);
+			}
+		}
+	}
+	
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		for (SkipConnection const & c : _layers[l].skipConnections)
+		{
+			_neurons[c.sourceLayer][c.sourceIndex].addOutput(c.connection);
+			_neurons[l][c.destinationIndex].addInput(c.connection);
+		}
+	}
+	
+	_connectionViewsBuilt = true;
 }
 
 void NeuralNetwork::setConnectionWeight(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationLayer, unsigned destinationIndex, float weight)
@@ -174,30 +254,84 @@ void NeuralNetwork::setConnectionWeight(unsigned sourceLayer, unsigned sourceInd
 		return;
 	}
 	
-	getNeuron(sourceLayer, sourceIndex)->setConnectionWeight(getNeuron(destinationLayer, destinationIndex), weight);
+	Layer & layer = _layers[destinationLayer];
+	
+	if (destinationLayer == sourceLayer + 1)
+		layer.weights[destinationIndex * layer.previousSize + sourceIndex] = weight;
+	else
+		layer.skipConnections[layer.findSkipConnection(sourceLayer, sourceIndex, destinationIndex)].connection->setWeight(weight);
 }
 
 bool NeuralNetwork::connectionExists(unsigned sourceLayer, unsigned sourceIndex, unsigned destinationLayer, unsigned destinationIndex) const
 {
-	return getNeuron(sourceLayer, sourceIndex)->connectedToDestination(getNeuron(destinationLayer, destinationIndex));
+	//Connections always go forward, the ones between adjacent layers are in the connection matrix of the destination layer and the others in its index
+	if (!neuronExists(sourceLayer, sourceIndex) || !neuronExists(destinationLayer, destinationIndex) || destinationLayer <= sourceLayer)
+		return false;
+	
+	Layer const & layer = _layers[destinationLayer];
+	
+	if (destinationLayer == sourceLayer + 1)
+		return layer.hasConnection(destinationIndex * layer.previousSize + sourceIndex);
+	
+	return layer.findSkipConnection(sourceLayer, sourceIndex, destinationIndex) >= 0;
 }
 
 void NeuralNetwork::connectAllLayers()
 {
 	//For each neuron from the first layer to the second to last layer
-	for (auto layer = _neurons.begin() ; layer != std::prev(_neurons.end()) ; layer++)
+	unsigned layerIndex = 0;
+	for (auto layer = _neurons.begin() ; layer != std::prev(_neurons.end()) ; layer++, layerIndex++)
 	{
-		for (auto neuron = layer->begin() ; neuron != layer->end() ; neuron++)
+		//Every neuron gets a whole layer of new connections, so their lists grow only once
+		for (Neuron & neuron : *layer)
+			neuron._outputNeurons.reserve(neuron._outputNeurons.size() + std::next(layer)->size());
+		
+		for (Neuron & neuron : *std::next(layer))
+			neuron._inputNeurons.reserve(neuron._inputNeurons.size() + layer->size());
+		
+		unsigned sourceIndex = 0;
+		for (auto neuron = layer->begin() ; neuron != layer->end() ; neuron++, sourceIndex++)
 		{
 			//Connect the neuron to all the neurons of the next layer
-			for (auto nextLayerNeuron = std::next(layer)->begin() ; nextLayerNeuron != std::next(layer)->end() ; nextLayerNeuron++)
+			unsigned destinationIndex = 0;
+			for (auto nextLayerNeuron = std::next(layer)->begin() ; nextLayerNeuron != std::next(layer)->end() ; nextLayerNeuron++, destinationIndex++)
 			{
-				connect(&(*neuron), &(*nextLayerNeuron));
+				connect(&(*neuron), &(*nextLayerNeuron), layerIndex, sourceIndex, layerIndex+1, destinationIndex);
 			}
 		}
 	}
 }	
 
+void NeuralNetwork::setRecurrent(unsigned layer)
+{
+	if (layer == 0 || layer + 1 >= _layers.size())
+	{
+		ERROR_MSG("Only a hidden layer can be recurrent (layer " << layer << " is not one)");
+		return;
+	}
+	
+	if (_layers[layer].isRecurrent())
+	{
+		INFO_MSG("Layer " << layer << " is already recurrent");
+		return;
+	}
+	
+	Layer & l = _layers[layer];
+	l.makeRecurrent();
+	
+	//The recurrent weights are drawn like the weights of new connections
+	for (unsigned k=0 ; k<l.getNumberOfRecurrentWeights() ; k++)
+	{
+		l.recurrentWeights[k] = drawWeight();
+		l.recurrentLearningRates[k] = Connection::getDefaultLearningRate();
+	}
+}
+
+bool NeuralNetwork::isRecurrent(unsigned layer) const
+{
+	return layer < _layers.size() && _layers[layer].isRecurrent();
+}
+
 void NeuralNetwork::addLearningPoint(LearningVector const & inputs, LearningVector const & outputs)
 {
 	if (getNumberOfNeuronsOnLayer(0) != inputs.size())
@@ -212,189 +346,2080 @@ void NeuralNetwork::addLearningPoint(LearningVector const & inputs, LearningVect
 		return;
 	}
 		
-	_learningSet.push_back(std::make_pair(inputs, outputs));
+	if (_learningSet.empty())
+		_learningSet.setSizes(inputs.size(), outputs.size());
+	
+	_learningSet.add(inputs.data(), outputs.data());
+	_sequenceLengths.push_back(1);
+}
+
+void NeuralNetwork::addLearningSequence(std::vector<LearningVector> const & inputs, std::vector<LearningVector> const & outputs)
+{
+	if (inputs.empty() || inputs.size() != outputs.size())
+	{
+		ERROR_MSG("A learning sequence needs as many output vectors (" << outputs.size() << ") as input vectors (" << inputs.size() << "), and at least one");
+		return;
+	}
+	
+	for (unsigned t=0 ; t<inputs.size() ; t++)
+	{
+		if (inputs[t].size() != getNumberOfNeuronsOnLayer(0) || outputs[t].size() != getNumberOfNeuronsOnLayer(getNumberOfLayers()-1))
+		{
+			ERROR_MSG("Learning vectors of time step " << t << " do not match the number of input or output neurons");
+			return;
+		}
+	}
+	
+	if (_learningSet.empty())
+		_learningSet.setSizes(inputs.front().size(), outputs.front().size());
+	
+	//The points of a sequence are contiguous in the learning set
+	_learningSet.reserve(_learningSet.size() + inputs.size());
+	
+	for (unsigned t=0 ; t<inputs.size() ; t++)
+		_learningSet.add(inputs[t].data(), outputs[t].data());
+	
+	_sequenceLengths.push_back(inputs.size());
 }
 
 void NeuralNetwork::clearLearningSet()
 {
 	_learningSet.clear();
+	_sequenceLengths.clear();
 }
 
 void NeuralNetwork::appendLearningSet(LearningSet const & set)
 {
-	_learningSet.insert(_learningSet.begin(), set.begin(), set.end());
+	if (_learningSet.empty())
+		_learningSet.setSizes(getNumberOfNeuronsOnLayer(0), getNumberOfNeuronsOnLayer(getNumberOfLayers()-1));
+	
+	_learningSet.reserve(_learningSet.size() + set.size());
+	
+	for (LearningPoint const & p : set)
+		addLearningPoint(p.first, p.second);
 }
 
-void NeuralNetwork::setLearningRate(float learningRate)
+void NeuralNetwork::setLearningSource(std::shared_ptr<LearningSource> source)
 {
-	for (ConnectionPtr c : _connections)
-		c->setLearningRate(learningRate);
+	_learningSource = source;
 }
 
-unsigned NeuralNetwork::train(Verbose verbose)
+void NeuralNetwork::setShuffling(bool enabled)
 {
-	/* Here is how we train a neural network:
-	 *  - compute the output values (from the second layer to the last layer)
-	 *  - compute the NN error ; if it is close enough to the last one (null derivative), stop the algorithm
-	 *  - compute the derivative of the error with respect to the net value for each neuron (from the last layer to the second one)
-	 *  - update the weight of each connection (no order)
-	 *  - go back to first step
-	 */
-	 
-	//Before all this we need to make sure that all bias neurons are a non zero value (let's say 1)
-	setBiasNeurons(1.f);
-	 
-	//Shit's getting real now
-	float error = std::numeric_limits<float>::max();
-	float lastError = std::numeric_limits<float>::min();
-	unsigned cycles = 0;
-	
-	while (std::abs(error - lastError) > 0.00001)
+	_shuffling = enabled;
+}
+
+bool NeuralNetwork::getShuffling() const
+{
+	return _shuffling;
+}
+
+void NeuralNetwork::setSeed(unsigned seed)
+{
+	_generator.seed(seed);
+}
+
+void NeuralNetwork::setLearningRate(float learningRate)
+{
+	//The learning rates of missing connections stay null, the layers tell which ones exist without the views of a loaded network
+	for (Layer & layer : _layers)
 	{
-		lastError = error;
-		error = 0.f;
-		
-		if (verbose == Verbose::Full)
-			DEBUG_MSG("STARTING CYCLE " << cycles);
-		
-		unsigned step = 0;
-		for (LearningPoint const & p : _learningSet)
+		for (unsigned k=0 ; k<layer.getNumberOfWeights() ; k++)
 		{
-			setInputs(p.first);
-			computeOutputs();
-			setDesiredOutputs(p.second);
-			error += getError();
-			
-			if (verbose == Verbose::Full)
-				DEBUG_MSG("   Learning point " << step << ": error = " << error);
-			step++;
-			
-			computeDerivativesOfErrorToNets();
-			updateWeights();
+			if (layer.hasConnection(k))
+				layer.learningRates[k] = learningRate;
 		}
 		
-		if (verbose >= Verbose::Medium)
-			DEBUG_MSG("Cycle " << cycles << ": error = " << error);
-		cycles++;
+		for (SkipConnection & c : layer.skipConnections)
+			c.connection->setLearningRate(learningRate);
+		
+		std::fill(layer.recurrentLearningRates, layer.recurrentLearningRates + layer.getNumberOfRecurrentWeights(), learningRate);
 	}
-	
-	return cycles;
 }
 
-LearningVector NeuralNetwork::process(LearningVector const & inputs)
+void NeuralNetwork::setOptimizer(Optimizer const & optimizer)
 {
-	setInputs(inputs);
-	computeOutputs();
-	
-	LearningVector result;
-	
-	for (auto neuron = _neurons.back().begin() ; neuron != _neurons.back().end() ; neuron++)
+	_optimizer = optimizer;
+}
+
+Optimizer const & NeuralNetwork::getOptimizer() const
+{
+	return _optimizer;
+}
+
+void NeuralNetwork::setLearningRateSchedule(std::shared_ptr<LearningRateSchedule> schedule)
+{
+	_learningRateSchedule = schedule;
+}
+
+void NeuralNetwork::setBatchSize(unsigned batchSize)
+{
+	if (batchSize == 0)
 	{
-		result.push_back(neuron->getOutputValue());
+		ERROR_MSG("Batch size must be at least 1");
+		return;
 	}
 	
-	return result;
+	_batchSize = batchSize;
 }
 
-void NeuralNetwork::setBiasNeurons(float constantValue)
+unsigned NeuralNetwork::getBatchSize() const
 {
-	for (auto layer = std::next(_neurons.begin()) ; layer != std::prev(_neurons.end()) ; layer++) //Bias neurons cannot be inside the first or last layers
-	{
-		for (auto neuron = layer->begin() ; neuron != layer->end() ; neuron++)
-		{
-			if (neuron->getNumberOfInputs() == 0) //Means it's a bias neuron
-				neuron->setOutputValue(constantValue);
-		}
-	}
+	return _batchSize;
 }
 
-void NeuralNetwork::setInputs(LearningVector const & values)
+void NeuralNetwork::setNumberOfThreads(unsigned numberOfThreads)
 {
-	if (getNumberOfNeuronsOnLayer(0) != values.size())
+	if (numberOfThreads == 0)
 	{
-		ERROR_MSG("Input learning vector size (" << values.size() << ") and number of input neurons (" << getNumberOfNeuronsOnLayer(0) << ") are not equal");
+		ERROR_MSG("Number of threads must be at least 1");
 		return;
 	}
+	
+	if (numberOfThreads == 1)
+		_threadPool.reset();
+	else
+		_threadPool.reset(new ThreadPool(numberOfThreads));
+}
+
+unsigned NeuralNetwork::getNumberOfThreads() const
+{
+	return _threadPool ? _threadPool->getNumberOfThreads() : 1;
+}
 
-	std::list<Neuron> & layer = _neurons.front();
-	for (auto neuron = layer.begin() ; neuron != layer.end() ; neuron++)
-		neuron->setOutputValue(values[std::distance(layer.begin(),neuron)]);
+void NeuralNetwork::setFastActivation(bool enabled)
+{
+	_fastActivation = enabled;
 }
-	
-void NeuralNetwork::setDesiredOutputs(LearningVector const & values)
+
+bool NeuralNetwork::getFastActivation() const
+{
+	return _fastActivation;
+}
+
+void NeuralNetwork::setActivation(unsigned layer, Activation activation)
 {
-	if (getNumberOfNeuronsOnLayer(getNumberOfLayers()-1) != values.size())
+	if (layer == 0 || layer >= getNumberOfLayers())
 	{
-		ERROR_MSG("Output learning vector size (" << values.size() << ") and number of output neurons (" << getNumberOfNeuronsOnLayer(getNumberOfLayers()-1) << ") are not equal");
+		ERROR_MSG("Cannot set the activation function of layer " << layer << " because it does not exist or is the input layer");
 		return;
 	}
-
-	std::list<Neuron> & layer = _neurons.back();
-	for (auto neuron = layer.begin() ; neuron != layer.end() ; neuron++)
-		neuron->setDesiredOutputValue(values[std::distance(layer.begin(),neuron)]);
+	
+	_layers[layer].activation = activation;
 }
 
-void NeuralNetwork::computeOutputs()
+Activation NeuralNetwork::getActivation(unsigned layer) const
 {
-	for (auto layer = std::next(_neurons.begin()) ; layer != _neurons.end() ; layer++) //We should never compute the input layer (it is fixed by the user)
+	if (layer >= getNumberOfLayers())
 	{
-		#ifdef ENABLE_OPENMP
-		__gnu_parallel::for_each(layer->begin(), layer->end(), [](Neuron & neuron){ neuron.compute(); });
-		#else
-		for (auto neuron = layer->begin() ; neuron != layer->end() ; neuron++)
-		{
-			neuron->compute();
-		}
-		#endif
+		ERROR_MSG("Cannot get the activation function of layer " << layer << " because it does not exist");
+		return Activation::Tanh;
 	}
+	
+	return _layers[layer].activation;
 }
 
-float NeuralNetwork::getError() const
+void NeuralNetwork::setLoss(Loss loss)
 {
-	float error = 0.f;
-	
-	for (auto neuron = _neurons.back().begin() ; neuron != _neurons.back().end() ; neuron++)
+	_loss = loss;
+}
+
+Loss NeuralNetwork::getLoss() const
+{
+	return _loss;
+}
+
+void NeuralNetwork::setTruncationLength(unsigned truncationLength)
+{
+	_truncationLength = truncationLength;
+}
+
+unsigned NeuralNetwork::getTruncationLength() const
+{
+	return _truncationLength;
+}
+
+void NeuralNetwork::addTrainingObserver(std::shared_ptr<TrainingObserver> observer)
+{
+	if (!observer)
 	{
-		error += neuron->getError();
+		ERROR_MSG("Cannot add a null training observer");
+		return;
 	}
 	
-	return error;
+	_observers.push_back(observer);
+}
+
+void NeuralNetwork::removeTrainingObserver(std::shared_ptr<TrainingObserver> const & observer)
+{
+	_observers.erase(std::remove(_observers.begin(), _observers.end(), observer), _observers.end());
+}
+
+void NeuralNetwork::setMaximumNumberOfCycles(unsigned maximumNumberOfCycles)
+{
+	_maximumNumberOfCycles = maximumNumberOfCycles;
+}
+
+void NeuralNetwork::setTimeLimit(double seconds)
+{
+	_timeLimit = seconds;
 }
 
-void NeuralNetwork::computeDerivativesOfErrorToNets()
+void NeuralNetwork::addValidationPoint(LearningVector const & inputs, LearningVector const & outputs)
 {
-	for (auto layer = _neurons.rbegin() ; layer != std::prev(_neurons.rend()) ; layer++) //We're going backward from the last layer to the second layer (intput neurons cannot have any contribution to the network error)
+	if (inputs.size() != getNumberOfNeuronsOnLayer(0) || outputs.size() != getNumberOfNeuronsOnLayer(getNumberOfLayers()-1))
 	{
-		#ifdef ENABLE_OPENMP
-		__gnu_parallel::for_each(layer->begin(), layer->end(), [](Neuron & neuron){ neuron.computeDerativeOfErrorToNetValue(); });
-		#else
-		for (auto neuron = layer->begin() ; neuron != layer->end() ; neuron++)
-		{
-			neuron->computeDerativeOfErrorToNetValue();
-		}
-		#endif
+		ERROR_MSG("Validation vectors of sizes " << inputs.size() << " and " << outputs.size() << " do not match the number of input or output neurons");
+		return;
 	}
+	
+	if (_validationSet.empty())
+		_validationSet.setSizes(inputs.size(), outputs.size());
+	
+	_validationSet.add(inputs.data(), outputs.data());
+}
+
+void NeuralNetwork::clearValidationSet()
+{
+	_validationSet.clear();
 }
 
-void NeuralNetwork::updateWeights()
+void NeuralNetwork::setValidationSplit(float fraction)
 {
-	for (auto connection = _connections.begin() ; connection != _connections.end() ; connection++)
+	if (fraction < 0.f || fraction >= 1.f)
 	{
-		(*connection)->updateWeight();
+		ERROR_MSG("The validation split must be at least 0 and less than 1");
+		return;
 	}
+	
+	_validationSplit = fraction;
 }
 
-std::string NeuralNetwork::toString() const
+void NeuralNetwork::setPatience(unsigned patience)
 {
-	std::stringstream ss;
+	_patience = patience;
+}
+
+void NeuralNetwork::setCheckpoint(std::string const & fileName, unsigned interval)
+{
+	if (!fileName.empty() && interval == 0)
+	{
+		ERROR_MSG("The checkpoint interval must be at least 1 cycle");
+		return;
+	}
 	
-	for (auto neuron = _neurons.back().begin() ; neuron != _neurons.back().end() ; neuron++)
+	_checkpointFileName = fileName;
+	_checkpointInterval = interval;
+}
+
+void NeuralNetwork::stopTraining()
+{
+	_stopRequested = true;
+}
+
+NeuralNetwork::StopReason NeuralNetwork::getStopReason() const
+{
+	return _stopReason;
+}
+
+float NeuralNetwork::getValidationError() const
+{
+	return _validationError;
+}
+
+void NeuralNetwork::setSparseThreshold(float maximumFillRatio)
+{
+	_sparseThreshold = maximumFillRatio;
+	_sparseLayersOutdated = true;
+}
+
+bool NeuralNetwork::isSparse(unsigned layer) const
+{
+	if (layer >= _layers.size())
 	{
-		ss << neuron->toString();
-		if (neuron != std::prev(_neurons.back().end()))
-			ss << " + ";
+		ERROR_MSG("Layer " << layer << " does not exist");
+		return false;
 	}
 	
-	return ss.str();
+	return _layers[layer].getNumberOfWeights() != 0 && _layers[layer].getFillRatio() < _sparseThreshold;
+}
+
+void NeuralNetwork::setParallelMode(ParallelMode mode)
+{
+	_parallelMode = mode;
+}
+
+NeuralNetwork::ParallelMode NeuralNetwork::getParallelMode() const
+{
+	return _parallelMode;
 }
 
+unsigned NeuralNetwork::train(Verbose verbose)
+{
+	/* Here is how we train a neural network:
+	 *  - compute the output values (from the second layer to the last layer)
+	 *  - compute the NN error ; if it is close enough to the last one (null derivative), stop the algorithm
+	 *  - compute the derivative of the error with respect to the net value for each neuron (from the last layer to the second one)
+	 *  - add the gradient of each connection to the gradients of the current batch
+	 *  - update the weight of each connection (no order) once the batch is complete
+	 *  - go back to first step
+	 */
+	 
+	if (!_learningSet.empty() && (_learningSet.getInputSize() != _layers.front().size || _learningSet.getOutputSize() != _layers.back().size))
+	{
+		ERROR_MSG("The learning points were added for another number of input or output neurons");
+		return 0;
+	}
+	
+	if (!_layers.empty() && !Activations::isCompatible(_loss, _layers.back().activation))
+	{
+		ERROR_MSG("The " << Activations::toString(_loss) << " loss cannot be used with a " << Activations::toString(_layers.back().activation) << " output layer");
+		return 0;
+	}
+	
+	const bool recurrent = hasRecurrentLayers();
+	
+	if (recurrent && _learningSource)
+	{
+		ERROR_MSG("Recurrent networks are trained on the learning sequences, not on a learning source");
+		return 0;
+	}
+	
+	//Before all this we need to make sure that all bias neurons are a non zero value (let's say 1)
+	setBiasNeurons(_values, 1.f);
+	
+	//The topology is final, allocate the gradient buffers (and the workspaces of the threads) and choose the dense or sparse kernels of each layer
+	compileSparseLayers();
+	
+	_gradients.clear();
+	for (Layer const & layer : _layers)
+		_gradients.emplace_back(layer);
+	
+	//The state of the optimizer has the layout of the gradients, it starts from zero at each call
+	_firstStates.clear();
+	_secondStates.clear();
+	_numberOfSteps = 0;
+	
+	for (Layer const & layer : _layers)
+	{
+		if (_optimizer.getNumberOfStates() >= 1)
+			_firstStates.emplace_back(layer);
+		
+		if (_optimizer.getNumberOfStates() >= 2)
+			_secondStates.emplace_back(layer);
+	}
+	
+	_workspaces.clear();
+	if (_threadPool)
+	{
+		_workspaces.resize(_threadPool->getNumberOfThreads());
+		
+		for (Workspace & workspace : _workspaces)
+		{
+			for (Layer const & layer : _layers)
+			{
+				workspace.values.emplace_back(layer.size);
+				workspace.gradients.emplace_back(layer);
+			}
+			
+			setBiasNeurons(workspace.values, 1.f);
+		}
+	}
+	
+	//Backpropagation through time keeps the values of every step of a window, they are allocated once here and never in the time loop
+	_timeSteps.clear();
+	if (recurrent)
+	{
+		unsigned window = _truncationLength;
+		
+		if (window == 0)
+			window = _sequenceLengths.empty() ? 1 : *std::max_element(_sequenceLengths.begin(), _sequenceLengths.end());
+		
+		_timeSteps.resize(window + 1);
+		
+		for (std::vector<LayerValues> & values : _timeSteps)
+		{
+			for (Layer const & layer : _layers)
+				values.emplace_back(layer.size);
+			
+			setBiasNeurons(values, 1.f);
+		}
+	}
+	 
+	/* The validation points are never trained on. Without validation points, the last points of the learning set are held out
+	 * by removing them from its index array for the duration of the training (they are copied into a set of their own).
+	 * The shuffles also only permute the index array (and the order of the sequences), both are restored at the end of the training.
+	 */
+	PackedLearningSet heldOutSet;
+	const bool split = _validationSet.empty() && _validationSplit > 0.f && !_learningSource && !recurrent;
+	const bool shuffled = _shuffling && !_learningSource;
+	std::vector<unsigned> originalIndices;
+	std::vector<unsigned> originalSequenceLengths;
+	
+	if (split || shuffled)
+		originalIndices = _learningSet.getIndices();
+	
+	if (shuffled && recurrent)
+		originalSequenceLengths = _sequenceLengths;
+	
+	if (split)
+	{
+		std::vector<unsigned> & indices = _learningSet.getIndices();
+		const unsigned numberOfHeldOutPoints = indices.size() * _validationSplit;
+		
+		heldOutSet.setSizes(_learningSet.getInputSize(), _learningSet.getOutputSize());
+		heldOutSet.reserve(numberOfHeldOutPoints);
+		
+		for (unsigned point=indices.size()-numberOfHeldOutPoints ; point<indices.size() ; point++)
+			heldOutSet.add(_learningSet.getInputs(point), _learningSet.getOutputs(point));
+		
+		indices.resize(indices.size() - numberOfHeldOutPoints);
+	}
+	
+	PackedLearningSet const & validationSet = heldOutSet.empty() ? _validationSet : heldOutSet;
+	
+	if (recurrent && !validationSet.empty())
+		WARNING_MSG("The validation set is ignored for recurrent networks");
+	
+	const bool validated = !recurrent && !validationSet.empty();
+	
+	//Shit's getting real now
+	float error = std::numeric_limits<float>::max();
+	float lastError = std::numeric_limits<float>::min();
+	unsigned cycles = 0;
+	
+	//Early stopping watches the validation error (the training error without validation set) and keeps the best weights
+	float bestError = std::numeric_limits<float>::max();
+	unsigned cyclesWithoutImprovement = 0;
+	std::vector<float> bestWeights;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	
+	_stopRequested = false;
+	_stopReason = StopReason::Converged;
+	_validationError = 0.f;
+	
+	//Without observers the statistics are never measured (the timers do not even read the clock)
+	const bool observed = !_observers.empty();
+	
+	for (std::shared_ptr<TrainingObserver> const & observer : _observers)
+		observer->onTrainingBegin();
+	
+	while (std::abs(error - lastError) > 0.00001)
+	{
+		lastError = error;
+		error = 0.f;
+		_statistics = TrainingStatistics();
+		PhaseTimer cycleTimer(observed);
+		
+		if (verbose == Verbose::Full)
+			DEBUG_MSG("STARTING CYCLE " << cycles);
+		
+		_learningRateFactor = _learningRateSchedule ? _learningRateSchedule->getFactor(cycles) : 1.f;
+		
+		//The order is drawn on the calling thread before the cycle, so it does not depend on the number of threads
+		if (recurrent)
+		{
+			if (shuffled)
+				shuffleSequences();
+			
+			error = trainSequences(_learningSet, error, verbose);
+		}
+		else if (_learningSource)
+		{
+			//Only one chunk of the learning points is in memory at a time, the source reads the next ones meanwhile (each chunk is shuffled on its own)
+			_learningSource->rewind();
+			
+			while (readChunk())
+			{
+				if (_shuffling)
+					shuffle(_chunk.getIndices());
+				
+				error = trainCycle(_chunk, error, verbose);
+			}
+		}
+		else
+		{
+			if (shuffled)
+				shuffle(_learningSet.getIndices());
+			
+			error = trainCycle(_learningSet, error, verbose);
+		}
+		
+		if (validated)
+			_validationError = getBatchError(validationSet, nullptr, _batchValues);
+		
+		if (observed)
+		{
+			cycleTimer.stop(_statistics.duration);
+			_statistics.validationError = validated ? _validationError : -1.f;
+			notifyObservers(cycles, error);
+		}
+		
+		if (verbose >= Verbose::Medium)
+			DEBUG_MSG("Cycle " << cycles << ": error = " << error << (validated ? ", validation error = " + std::to_string(_validationError) : std::string()));
+		cycles++;
+		
+		if (!_checkpointFileName.empty() && cycles % _checkpointInterval == 0)
+			writeCheckpoint();
+		
+		if (_patience != 0)
+		{
+			const float monitoredError = validated ? _validationError : error;
+			
+			if (monitoredError < bestError)
+			{
+				bestError = monitoredError;
+				cyclesWithoutImprovement = 0;
+				bestWeights.resize(getNumberOfWeights());
+				getWeights(bestWeights.data());
+			}
+			else if (++cyclesWithoutImprovement >= _patience)
+			{
+				setWeights(bestWeights.data());
+				_validationError = validated ? bestError : _validationError;
+				_stopReason = StopReason::EarlyStopping;
+				break;
+			}
+		}
+		
+		if (_stopRequested)
+		{
+			_stopReason = StopReason::Stopped;
+			break;
+		}
+		
+		if (_maximumNumberOfCycles != 0 && cycles >= _maximumNumberOfCycles)
+		{
+			_stopReason = StopReason::MaximumNumberOfCycles;
+			break;
+		}
+		
+		if (_timeLimit > 0. && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= _timeLimit)
+		{
+			_stopReason = StopReason::TimeLimit;
+			break;
+		}
+	}
+	
+	//The held out points go back into the learning set, which is visited in its original order again
+	if (split || shuffled)
+		_learningSet.getIndices().swap(originalIndices);
+	
+	if (shuffled && recurrent)
+		_sequenceLengths.swap(originalSequenceLengths);
+	
+	//train() returns once the last checkpoint is complete, so that it can be loaded right away
+	if (_checkpointWriter.joinable())
+		_checkpointWriter.join();
+	
+	if (verbose >= Verbose::Medium)
+		DEBUG_MSG("Training stopped after " << cycles << " cycles: " << toString(_stopReason));
+	
+	for (std::shared_ptr<TrainingObserver> const & observer : _observers)
+		observer->onTrainingEnd(cycles, error);
+	
+	return cycles;
+}
+
+void NeuralNetwork::writeCheckpoint()
+{
+	//The network is serialized on the training thread (a copy of the weights), only the file is written on the background thread
+	std::vector<char> buffer;
+	
+	if (!serialize(buffer))
+		return;
+	
+	std::lock_guard<std::mutex> lock(_checkpointMutex);
+	
+	//While a file is being written, the newest checkpoint waits for the writer (replacing an older one which was waiting too)
+	_pendingCheckpoint.swap(buffer);
+	
+	if (_checkpointBusy)
+		return;
+	
+	if (_checkpointWriter.joinable())
+		_checkpointWriter.join();
+	
+	_checkpointBusy = true;
+	_checkpointWriter = std::thread(&NeuralNetwork::writeCheckpoints, this, _checkpointFileName);
+}
+
+void NeuralNetwork::writeCheckpoints(std::string const & fileName)
+{
+	//The file is written under another name then renamed, so that the checkpoint on disk is always complete
+	const std::string temporaryFileName = fileName + ".tmp";
+	std::vector<char> buffer;
+	
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_checkpointMutex);
+			
+			if (_pendingCheckpoint.empty())
+			{
+				_checkpointBusy = false;
+				return;
+			}
+			
+			buffer.swap(_pendingCheckpoint);
+			_pendingCheckpoint.clear();
+		}
+		
+		if (writeFile(temporaryFileName, buffer) && std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+			ERROR_MSG("Cannot rename " << temporaryFileName << " into " << fileName);
+	}
+}
+
+std::string NeuralNetwork::toString(StopReason reason)
+{
+	switch (reason)
+	{
+		case StopReason::MaximumNumberOfCycles:
+			return "maximum number of cycles reached";
+		case StopReason::TimeLimit:
+			return "time limit reached";
+		case StopReason::EarlyStopping:
+			return "no improvement of the error during the patience";
+		case StopReason::Stopped:
+			return "stopped by stopTraining()";
+		default:
+			return "error converged";
+	}
+}
+
+void NeuralNetwork::notifyObservers(unsigned cycle, float error)
+{
+	//The counters of the threads are merged: the times are averaged (the threads run at the same time), the updates are summed
+	for (Workspace & workspace : _workspaces)
+	{
+		_statistics.forwardTime += workspace.statistics.forwardTime / _workspaces.size();
+		_statistics.backwardTime += workspace.statistics.backwardTime / _workspaces.size();
+		_statistics.updateTime += workspace.statistics.updateTime / _workspaces.size();
+		_statistics.gradientNorm += workspace.statistics.gradientNorm;
+		_statistics.numberOfUpdates += workspace.statistics.numberOfUpdates;
+		workspace.statistics = TrainingStatistics();
+	}
+	
+	_statistics.cycle = cycle;
+	_statistics.error = error;
+	_statistics.pointsPerSecond = _statistics.duration > 0. ? _statistics.numberOfPoints / _statistics.duration : 0.;
+	
+	if (_statistics.numberOfUpdates != 0)
+		_statistics.gradientNorm /= _statistics.numberOfUpdates;
+	
+	for (std::shared_ptr<TrainingObserver> const & observer : _observers)
+		observer->onCycleEnd(_statistics);
+}
+
+float NeuralNetwork::trainCycle(PackedLearningSet const & set, float error, Verbose verbose)
+{
+	const unsigned numberOfPoints = set.size();
+	const bool observed = !_observers.empty();
+	PhaseTimer timer(observed);
+	
+	_statistics.numberOfPoints += numberOfPoints;
+	
+	if (_threadPool && _parallelMode == ParallelMode::Hogwild)
+	{
+		error += trainCycleAsynchronously(set);
+	}
+	else
+	{
+		for (unsigned first=0 ; first<numberOfPoints ; first+=_batchSize)
+		{
+			const unsigned last = std::min(first + _batchSize, numberOfPoints);
+			
+			if (_threadPool)
+			{
+				error += trainBatchInParallel(set, first, last);
+				continue;
+			}
+			
+			//The timer runs continuously (each stop() starts the next phase), so that a learning point only reads the clock a few times
+			for (unsigned step=first ; step<last ; step++)
+			{
+				setInputs(_values, set.getInputs(step));
+				computeOutputs(_values);
+				setDesiredOutputs(_values, set.getOutputs(step));
+				error += getError(_values);
+				timer.stop(_statistics.forwardTime);
+				
+				if (verbose == Verbose::Full)
+					DEBUG_MSG("   Learning point " << step << ": error = " << error);
+				
+				computeDerivativesOfErrorToNets(_values);
+				accumulateGradients(_values, _gradients);
+				timer.stop(_statistics.backwardTime);
+			}
+			
+			if (observed)
+				addGradientNorm(_gradients);
+			
+			updateWeights(_gradients, nextStep());
+			timer.stop(_statistics.updateTime);
+		}
+	}
+	
+	return error;
+}
+
+float NeuralNetwork::trainSequences(PackedLearningSet const & set, float error, Verbose verbose)
+{
+	/* Truncated backpropagation through time: each sequence is cut into windows of at most window time steps.
+	 * The forward pass keeps the values of every step of the window in _timeSteps[1..n], then the backward pass goes from the last step
+	 * to the first one, each step receiving the derivatives of the next one through the recurrent matrices, and the weights are updated.
+	 * The state is carried over to the next window (in _timeSteps[0]) but the derivatives are not.
+	 */
+	const unsigned window = _timeSteps.size() - 1;
+	const bool observed = !_observers.empty();
+	PhaseTimer timer(observed);
+	unsigned first = 0;
+	
+	_statistics.numberOfPoints += set.size();
+	
+	for (unsigned length : _sequenceLengths)
+	{
+		for (unsigned begin=0 ; begin<length ; begin+=window)
+		{
+			const unsigned n = std::min(window, length - begin);
+			timer.restart();
+			
+			for (unsigned t=0 ; t<n ; t++)
+			{
+				const unsigned step = first + begin + t;
+				std::vector<LayerValues> & values = _timeSteps[t+1];
+				std::vector<LayerValues> const * previous = (begin == 0 && t == 0) ? nullptr : &_timeSteps[t];
+				
+				setInputs(values, set.getInputs(step));
+				computeOutputs(values, previous);
+				setDesiredOutputs(values, set.getOutputs(step));
+				error += getError(values);
+				
+				if (verbose == Verbose::Full)
+					DEBUG_MSG("   Learning point " << step << ": error = " << error);
+			}
+			
+			timer.stop(_statistics.forwardTime);
+			
+			for (unsigned t=n ; t-->0 ; )
+			{
+				std::vector<LayerValues> const * previous = (begin == 0 && t == 0) ? nullptr : &_timeSteps[t];
+				std::vector<LayerValues> const * next = (t+1 < n) ? &_timeSteps[t+2] : nullptr;
+				
+				computeDerivativesOfErrorToNets(_timeSteps[t+1], next);
+				accumulateGradients(_timeSteps[t+1], _gradients, previous);
+			}
+			
+			timer.stop(_statistics.backwardTime);
+			
+			if (observed)
+				addGradientNorm(_gradients);
+			
+			timer.restart();
+			updateWeights(_gradients, nextStep());
+			timer.stop(_statistics.updateTime);
+			std::swap(_timeSteps[0], _timeSteps[n]);
+		}
+		
+		first += length;
+	}
+	
+	return error;
+}
+
+bool NeuralNetwork::readChunk()
+{
+	//The chunk is a whole number of batches so that the batches do not depend on where the chunks end
+	const unsigned pointsPerChunk = (PrefetchedLearningSource::DefaultBufferSize + _batchSize - 1) / _batchSize * _batchSize;
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+	LearningVector inputs;
+	LearningVector outputs;
+	
+	if (_chunk.getInputSize() != numberOfInputs || _chunk.getOutputSize() != numberOfOutputs)
+		_chunk.setSizes(numberOfInputs, numberOfOutputs);
+	
+	_chunk.clear();
+	_chunk.reserve(pointsPerChunk);
+	
+	while (_chunk.size() < pointsPerChunk && _learningSource->next(inputs, outputs))
+	{
+		if (inputs.size() != numberOfInputs || outputs.size() != numberOfOutputs)
+		{
+			ERROR_MSG("Learning point with " << inputs.size() << " inputs and " << outputs.size() << " outputs does not match the network, ignoring it");
+			continue;
+		}
+		
+		_chunk.add(inputs.data(), outputs.data());
+	}
+	
+	return !_chunk.empty();
+}
+
+float NeuralNetwork::trainCycleAsynchronously(PackedLearningSet const & set)
+{
+	/* Hogwild: every thread runs the online training loop on its own shard of the learning set and updates the shared weights
+	 * right away, without any lock. Concurrent updates of the same weight may overwrite each other, which gradient descent
+	 * tolerates well as long as the updates are small and sparse. Values and derivatives stay private to each thread.
+	 */
+	const unsigned numberOfThreads = _threadPool->getNumberOfThreads();
+	const bool observed = !_observers.empty();
+	const bool sgd = _optimizer.getMethod() == Optimizer::Method::SGD;
+	std::vector<float> errors(numberOfThreads, 0.f);
+	
+	_threadPool->run([&](unsigned thread)
+	{
+		//The products would overflow 32 bits with large sets and many threads
+		const unsigned begin = static_cast<unsigned>(static_cast<std::size_t>(set.size()) * thread / numberOfThreads);
+		const unsigned end = static_cast<unsigned>(static_cast<std::size_t>(set.size()) * (thread+1) / numberOfThreads);
+		Workspace & workspace = _workspaces[thread];
+		TrainingStatistics & statistics = workspace.statistics;
+		PhaseTimer timer(observed);
+		float error = 0.f;
+		
+		for (unsigned step=begin ; step<end ; step++)
+		{
+			setInputs(workspace.values, set.getInputs(step));
+			computeOutputs(workspace.values);
+			setDesiredOutputs(workspace.values, set.getOutputs(step));
+			error += getError(workspace.values);
+			timer.stop(statistics.forwardTime);
+			
+			computeDerivativesOfErrorToNets(workspace.values);
+			timer.stop(statistics.backwardTime);
+			
+			if (observed)
+			{
+				statistics.gradientNorm += std::sqrt(getSquaredGradientNorm(workspace.values));
+				statistics.numberOfUpdates++;
+			}
+			
+			//The other optimizers go through the gradient buffers of the thread, their state is shared without locks like the weights
+			if (sgd)
+			{
+				updateWeights(workspace.values);
+			}
+			else
+			{
+				accumulateGradients(workspace.values, workspace.gradients);
+				updateWeights(workspace.gradients, _optimizer.getStep(_numberOfSteps + (step - begin) * numberOfThreads + thread + 1, _learningRateFactor));
+			}
+			
+			timer.stop(statistics.updateTime);
+		}
+		
+		errors[thread] = error;
+	});
+	
+	_numberOfSteps += set.size();
+	
+	float error = 0.f;
+	for (float e : errors)
+		error += e;
+	
+	return error;
+}
+
+float NeuralNetwork::trainBatchInParallel(PackedLearningSet const & set, unsigned first, unsigned last)
+{
+	const unsigned numberOfThreads = _threadPool->getNumberOfThreads();
+	const bool observed = !_observers.empty();
+	std::vector<float> errors(numberOfThreads, 0.f);
+	std::vector<double> squaredGradientNorms(observed ? numberOfThreads : 0, 0.);
+	
+	//Each thread runs the forward and backward passes on its own shard of the batch, with its own values and gradients
+	_threadPool->run([&](unsigned thread)
+	{
+		const unsigned begin = first + static_cast<unsigned>(static_cast<std::size_t>(last - first) * thread / numberOfThreads);
+		const unsigned end = first + static_cast<unsigned>(static_cast<std::size_t>(last - first) * (thread+1) / numberOfThreads);
+		Workspace & workspace = _workspaces[thread];
+		PhaseTimer timer(observed);
+		float error = 0.f;
+		
+		for (unsigned step=begin ; step<end ; step++)
+		{
+			setInputs(workspace.values, set.getInputs(step));
+			computeOutputs(workspace.values);
+			setDesiredOutputs(workspace.values, set.getOutputs(step));
+			error += getError(workspace.values);
+			timer.stop(workspace.statistics.forwardTime);
+			
+			computeDerivativesOfErrorToNets(workspace.values);
+			accumulateGradients(workspace.values, workspace.gradients);
+			timer.stop(workspace.statistics.backwardTime);
+		}
+		
+		errors[thread] = error;
+	});
+	
+	//The gradients are then reduced and applied, each thread on its own slice of the weights
+	PhaseTimer timer(observed);
+	const Optimizer::Step step = nextStep();
+	
+	_threadPool->run([&](unsigned thread)
+	{
+		updateWeights(thread, numberOfThreads, step, observed ? &squaredGradientNorms[thread] : nullptr);
+	});
+	
+	//The update is timed on the calling thread, it is the same for all the threads
+	if (observed)
+	{
+		double squaredGradientNorm = 0.;
+		for (double n : squaredGradientNorms)
+			squaredGradientNorm += n;
+		
+		timer.stop(_statistics.updateTime);
+		_statistics.gradientNorm += std::sqrt(squaredGradientNorm);
+		_statistics.numberOfUpdates++;
+	}
+	
+	float error = 0.f;
+	for (float e : errors)
+		error += e;
+	
+	return error;
+}
+
+LearningVector NeuralNetwork::process(LearningVector const & inputs)
+{
+	if (_layers.front().size != inputs.size())
+	{
+		ERROR_MSG("Input learning vector size (" << inputs.size() << ") and number of input neurons (" << _layers.front().size << ") are not equal");
+		return LearningVector();
+	}
+	
+	compileSparseLayers();
+	process(inputs.data(), _values);
+	
+	return _values.back().outputValues;
+}
+
+void NeuralNetwork::processBatch(float const * inputs, unsigned numberOfSamples, float * outputs)
+{
+	compileSparseLayers();
+	processBatch(inputs, numberOfSamples, outputs, _batchValues);
+}
+
+void NeuralNetwork::processBatch(std::vector<LearningVector> const & inputs, float * outputs)
+{
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+	
+	for (LearningVector const & input : inputs)
+	{
+		if (input.size() != numberOfInputs)
+		{
+			ERROR_MSG("Input learning vector size (" << input.size() << ") and number of input neurons (" << numberOfInputs << ") are not equal");
+			return;
+		}
+	}
+	
+	compileSparseLayers();
+	prepareBatchValues(_batchValues);
+	
+	for (unsigned first=0 ; first<inputs.size() ; first+=batchBlockSize)
+	{
+		const unsigned n = std::min(batchBlockSize, static_cast<unsigned>(inputs.size()) - first);
+		
+		float * blockInputs = _batchValues.front().outputValues.data();
+		for (unsigned s=0 ; s<n ; s++)
+			for (unsigned j=0 ; j<numberOfInputs ; j++)
+				blockInputs[j * n + s] = inputs[first + s][j];
+		
+		computeBatchOutputs(_batchValues, n, nullptr);
+		
+		float const * blockOutputs = _batchValues.back().outputValues.data();
+		for (unsigned s=0 ; s<n ; s++)
+			for (unsigned i=0 ; i<numberOfOutputs ; i++)
+				outputs[(first + s) * numberOfOutputs + i] = blockOutputs[i * n + s];
+	}
+}
+
+std::vector<LearningVector> NeuralNetwork::processSequence(std::vector<LearningVector> const & inputs)
+{
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+	std::vector<float> flatInputs;
+	
+	flatInputs.reserve(inputs.size() * numberOfInputs);
+	
+	for (LearningVector const & input : inputs)
+	{
+		if (input.size() != numberOfInputs)
+		{
+			ERROR_MSG("Input learning vector size (" << input.size() << ") and number of input neurons (" << numberOfInputs << ") are not equal");
+			return std::vector<LearningVector>();
+		}
+		
+		flatInputs.insert(flatInputs.end(), input.begin(), input.end());
+	}
+	
+	std::vector<float> flatOutputs(inputs.size() * numberOfOutputs);
+	processSequences(flatInputs.data(), 1, inputs.size(), flatOutputs.data());
+	
+	std::vector<LearningVector> outputs(inputs.size());
+	for (unsigned t=0 ; t<inputs.size() ; t++)
+		outputs[t].assign(&flatOutputs[t * numberOfOutputs], &flatOutputs[(t+1) * numberOfOutputs]);
+	
+	return outputs;
+}
+
+void NeuralNetwork::processSequences(float const * inputs, unsigned numberOfSequences, unsigned length, float * outputs)
+{
+	compileSparseLayers();
+	processSequences(inputs, numberOfSequences, length, outputs, _batchValues, _previousBatchValues);
+}
+
+void NeuralNetwork::process(float const * inputs, std::vector<LayerValues> & values) const
+{
+	setInputs(values, inputs);
+	computeOutputs(values);
+}
+
+void NeuralNetwork::processBatch(float const * inputs, unsigned numberOfSamples, float * outputs, std::vector<LayerValues> & values) const
+{
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+	
+	prepareBatchValues(values);
+	
+	for (unsigned first=0 ; first<numberOfSamples ; first+=batchBlockSize)
+	{
+		const unsigned n = std::min(batchBlockSize, numberOfSamples - first);
+		
+		//Transpose the block of inputs into the neuron-major layout
+		float * blockInputs = values.front().outputValues.data();
+		for (unsigned s=0 ; s<n ; s++)
+			for (unsigned j=0 ; j<numberOfInputs ; j++)
+				blockInputs[j * n + s] = inputs[(first + s) * numberOfInputs + j];
+		
+		computeBatchOutputs(values, n, nullptr);
+		
+		float const * blockOutputs = values.back().outputValues.data();
+		for (unsigned s=0 ; s<n ; s++)
+			for (unsigned i=0 ; i<numberOfOutputs ; i++)
+				outputs[(first + s) * numberOfOutputs + i] = blockOutputs[i * n + s];
+	}
+}
+
+void NeuralNetwork::processSequences(float const * inputs, unsigned numberOfSequences, unsigned length, float * outputs, std::vector<LayerValues> & values, std::vector<LayerValues> & previous) const
+{
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+	
+	prepareBatchValues(values);
+	prepareBatchValues(previous);
+	
+	//A block of sequences goes through the time steps together: each step is a batched forward pass whose previous values are the ones of the last step
+	for (unsigned first=0 ; first<numberOfSequences ; first+=batchBlockSize)
+	{
+		const unsigned n = std::min(batchBlockSize, numberOfSequences - first);
+		
+		for (unsigned t=0 ; t<length ; t++)
+		{
+			float * blockInputs = values.front().outputValues.data();
+			for (unsigned s=0 ; s<n ; s++)
+				for (unsigned j=0 ; j<numberOfInputs ; j++)
+					blockInputs[j * n + s] = inputs[(static_cast<std::size_t>(first + s) * length + t) * numberOfInputs + j];
+			
+			computeBatchOutputs(values, n, nullptr, t == 0 ? nullptr : &previous);
+			
+			float const * blockOutputs = values.back().outputValues.data();
+			for (unsigned s=0 ; s<n ; s++)
+				for (unsigned i=0 ; i<numberOfOutputs ; i++)
+					outputs[(static_cast<std::size_t>(first + s) * length + t) * numberOfOutputs + i] = blockOutputs[i * n + s];
+			
+			std::swap(values, previous);
+		}
+	}
+}
+
+void NeuralNetwork::setBiasNeurons(std::vector<LayerValues> & values, float constantValue) const
+{
+	for (unsigned l=1 ; l+1<_layers.size() ; l++) //Bias neurons cannot be inside the first or last layers
+	{
+		Layer const & layer = _layers[l];
+
+		for (unsigned i=0 ; i<layer.size ; i++)
+		{
+			if (layer.numberOfInputs[i] == 0) //Means it's a bias neuron
+				values[l].outputValues[i] = constantValue;
+		}
+	}
+}
+
+void NeuralNetwork::setInputs(std::vector<LayerValues> & values, float const * inputs) const
+{
+	//The sizes have been checked when the learning points were added
+	std::copy(inputs, inputs + _layers.front().size, values.front().outputValues.begin());
+}
+
+void NeuralNetwork::setDesiredOutputs(std::vector<LayerValues> & values, float const * outputs) const
+{
+	std::copy(outputs, outputs + _layers.back().size, values.back().desiredOutputValues.begin());
+}
+
+void NeuralNetwork::computeOutputs(std::vector<LayerValues> & values, std::vector<LayerValues> const * previous) const
+{
+	for (unsigned l=1 ; l<_layers.size() ; l++) //We should never compute the input layer (it is fixed by the user)
+	{
+		Layer const & layer = _layers[l];
+		float const * inputs = values[l-1].outputValues.data();
+		float * nets = values[l].netValues.data();
+		float * outputs = values[l].outputValues.data();
+
+		//Net values are the product of the weight matrix by the outputs of the previous layer (only its connections for a sparse layer)
+		if (layer.sparse)
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+			{
+				float const * row = &layer.weights[i * layer.previousSize];
+				float net = 0.f;
+				
+				for (unsigned k=layer.rowOffsets[i] ; k<layer.rowOffsets[i+1] ; k++)
+					net += row[layer.columns[k]] * inputs[layer.columns[k]];
+				
+				nets[i] = net;
+			}
+		}
+		else
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+				nets[i] = Simd::dot(&layer.weights[i * layer.previousSize], inputs, layer.previousSize);
+		}
+
+		for (SkipConnection const & c : layer.skipConnections)
+			nets[c.destinationIndex] += values[c.sourceLayer].outputValues[c.sourceIndex] * c.connection->getWeight();
+
+		//Recurrent layers also get their own outputs of the previous time step (a null state at the first one)
+		if (layer.isRecurrent() && previous)
+		{
+			float const * state = (*previous)[l].outputValues.data();
+			
+			for (unsigned i=0 ; i<layer.size ; i++)
+				nets[i] += Simd::dot(&layer.recurrentWeights[i * layer.size], state, layer.size);
+		}
+
+		if (layer.activation == Activation::Softmax)
+		{
+			Activations::softmax(nets, outputs, layer.numberOfInputs.data(), layer.size, 1);
+			continue;
+		}
+
+		//Neurons without inputs are bias neurons, their output is fixed: the activation function is applied to the runs of neurons between them
+		for (unsigned first=0 ; first<layer.size ; )
+		{
+			if (layer.numberOfInputs[first] == 0)
+			{
+				first++;
+				continue;
+			}
+			
+			unsigned last = first + 1;
+			while (last < layer.size && layer.numberOfInputs[last] != 0)
+				last++;
+			
+			Activations::activate(layer.activation, &nets[first], &outputs[first], last - first, _fastActivation);
+			first = last;
+		}
+	}
+}
+
+void NeuralNetwork::prepareBatchValues(std::vector<LayerValues> & values) const
+{
+	//Layers can only be appended, so the buffers only need to be completed
+	for (unsigned l=values.size() ; l<_layers.size() ; l++)
+		values.emplace_back(_layers[l].size * batchBlockSize);
+}
+
+void NeuralNetwork::computeBatchOutputs(std::vector<LayerValues> & values, unsigned numberOfSamples, float const * weights, std::vector<LayerValues> const * previous) const
+{
+	const unsigned n = numberOfSamples;
+	
+	//With external weights, the matrices, the skip connections and the recurrent matrices are read from the flat array (see getWeights())
+	float const * matrix = weights;
+	float const * skipWeights = weights ? weights + getNumberOfMatrixWeights() : nullptr;
+	float const * recurrentMatrix = weights ? weights + getNumberOfWeights() - getNumberOfRecurrentWeights() : nullptr;
+	
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		Layer const & layer = _layers[l];
+		float const * inputs = values[l-1].outputValues.data();
+		float * nets = values[l].netValues.data();
+		float * outputs = values[l].outputValues.data();
+		float const * layerWeights = weights ? matrix : layer.weights;
+		
+		//Matrix-matrix product: each weight is loaded once for the whole block and the inner loop runs over contiguous samples
+		for (unsigned i=0 ; i<layer.size ; i++)
+		{
+			float const * row = &layerWeights[i * layer.previousSize];
+			float * net = &nets[i * n];
+			std::fill(net, net + n, 0.f);
+			
+			if (layer.sparse)
+			{
+				for (unsigned k=layer.rowOffsets[i] ; k<layer.rowOffsets[i+1] ; k++)
+					Simd::axpy(row[layer.columns[k]], &inputs[layer.columns[k] * n], net, n);
+			}
+			else
+			{
+				for (unsigned j=0 ; j<layer.previousSize ; j++)
+					Simd::axpy(row[j], &inputs[j * n], net, n);
+			}
+		}
+		
+		for (SkipConnection const & c : layer.skipConnections)
+		{
+			const float weight = weights ? *skipWeights++ : c.connection->getWeight();
+			Simd::axpy(weight, &values[c.sourceLayer].outputValues[c.sourceIndex * n], &nets[c.destinationIndex * n], n);
+		}
+		
+		//The recurrent term is added in the same pass, before the activation, as another matrix-matrix product
+		if (layer.isRecurrent() && previous)
+		{
+			float const * recurrentWeights = weights ? recurrentMatrix : layer.recurrentWeights;
+			float const * state = (*previous)[l].outputValues.data();
+			
+			for (unsigned i=0 ; i<layer.size ; i++)
+				for (unsigned j=0 ; j<layer.size ; j++)
+					Simd::axpy(recurrentWeights[i * layer.size + j], &state[j * n], &nets[i * n], n);
+		}
+		
+		//Without a flat array both pointers stay null (moving a null pointer is undefined behavior)
+		if (weights)
+		{
+			matrix += layer.getNumberOfWeights();
+			recurrentMatrix += layer.getNumberOfRecurrentWeights();
+		}
+		
+		//The values of a run of neurons are contiguous, so the activation function is applied to the whole run at once
+		for (unsigned first=0 ; first<layer.size ; )
+		{
+			if (layer.numberOfInputs[first] == 0) //Bias neurons keep the value they have in the network
+			{
+				std::fill(&outputs[first * n], &outputs[first * n] + n, _values[l].outputValues[first]);
+				first++;
+				continue;
+			}
+			
+			unsigned last = first + 1;
+			while (last < layer.size && layer.numberOfInputs[last] != 0)
+				last++;
+			
+			if (layer.activation != Activation::Softmax)
+				Activations::activate(layer.activation, &nets[first * n], &outputs[first * n], (last - first) * n, _fastActivation);
+
+			first = last;
+		}
+
+		//The softmax of a sample mixes all the neurons of the layer, whose values are numberOfSamples apart
+		if (layer.activation == Activation::Softmax)
+		{
+			for (unsigned s=0 ; s<n ; s++)
+				Activations::softmax(&nets[s], &outputs[s], layer.numberOfInputs.data(), layer.size, n);
+		}
+	}
+}
+
+float NeuralNetwork::getBatchError(PackedLearningSet const & set, float const * weights, std::vector<LayerValues> & values) const
+{
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+	float error = 0.f;
+	
+	prepareBatchValues(values);
+	
+	for (unsigned first=0 ; first<set.size() ; first+=batchBlockSize)
+	{
+		const unsigned n = std::min(batchBlockSize, set.size() - first);
+		
+		float * blockInputs = values.front().outputValues.data();
+		for (unsigned s=0 ; s<n ; s++)
+		{
+			float const * inputs = set.getInputs(first + s);
+			for (unsigned j=0 ; j<numberOfInputs ; j++)
+				blockInputs[j * n + s] = inputs[j];
+		}
+		
+		computeBatchOutputs(values, n, weights);
+		
+		float const * blockOutputs = values.back().outputValues.data();
+		for (unsigned s=0 ; s<n ; s++)
+		{
+			float const * desiredOutputs = set.getOutputs(first + s);
+			for (unsigned i=0 ; i<numberOfOutputs ; i++)
+				error += Activations::getError(_loss, _layers.back().activation, desiredOutputs[i], blockOutputs[i * n + s]);
+		}
+	}
+	
+	return error;
+}
+
+float NeuralNetwork::getError(std::vector<LayerValues> const & values) const
+{
+	float error = 0.f;
+	LayerValues const & outputLayer = values.back();
+
+	for (unsigned i=0 ; i<_layers.back().size ; i++)
+	{
+		error += Activations::getError(_loss, _layers.back().activation, outputLayer.desiredOutputValues[i], outputLayer.outputValues[i]);
+	}
+
+	return error;
+}
+
+void NeuralNetwork::computeDerivativesOfErrorToNets(std::vector<LayerValues> & values, std::vector<LayerValues> const * next) const
+{
+	/* The derivatives of a layer are the sum of the derivatives of the next layers weighted by the connections.
+	 * Going backward, each layer first receives all these contributions, then multiplies them by the derivative of the activation function
+	 * and finally propagates its own derivatives to the previous layers.
+	 */
+
+	for (unsigned l=1 ; l<values.size() ; l++)
+		std::fill(values[l].derivativesOfErrorToNetValues.begin(), values[l].derivativesOfErrorToNetValues.end(), 0.f);
+
+	const unsigned outputLayer = _layers.size()-1;
+
+	for (unsigned l=outputLayer ; l>0 ; l--) //We're going backward from the last layer to the second layer (intput neurons cannot have any contribution to the network error)
+	{
+		Layer const & layer = _layers[l];
+		LayerValues & layerValues = values[l];
+		float * derivatives = layerValues.derivativesOfErrorToNetValues.data();
+
+		if (l == outputLayer)
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+				derivatives[i] = layerValues.outputValues[i] - layerValues.desiredOutputValues[i];
+		}
+
+		//The outputs of a recurrent layer are also inputs of the layer at the next time step (backpropagation through time)
+		if (layer.isRecurrent() && next)
+		{
+			float const * nextDerivatives = (*next)[l].derivativesOfErrorToNetValues.data();
+			
+			for (unsigned i=0 ; i<layer.size ; i++)
+				Simd::axpy(nextDerivatives[i], &layer.recurrentWeights[i * layer.size], derivatives, layer.size);
+		}
+
+		//With the cross-entropy (and a sigmoid or softmax output layer) output - desiredOutput already is the derivative with respect to the net value
+		if (l != outputLayer || _loss != Loss::CrossEntropy)
+		{
+			if (layer.activation == Activation::Softmax)
+				Activations::multiplyBySoftmaxDerivative(layerValues.outputValues.data(), derivatives, layer.numberOfInputs.data(), layer.size);
+			else
+				Activations::multiplyByDerivative(layer.activation, layerValues.outputValues.data(), derivatives, layer.size);
+		}
+
+		if (l == 1)
+			continue;
+
+		//Propagate to the previous layer with the transposed weight matrix (a sparse layer goes through the connections of each column of the CSC indices)
+		float * previousDerivatives = values[l-1].derivativesOfErrorToNetValues.data();
+
+		if (layer.sparse)
+		{
+			for (unsigned j=0 ; j<layer.previousSize ; j++)
+			{
+				float derivative = 0.f;
+				
+				for (unsigned k=layer.columnOffsets[j] ; k<layer.columnOffsets[j+1] ; k++)
+					derivative += derivatives[layer.rows[k]] * layer.weights[layer.rows[k] * layer.previousSize + j];
+				
+				previousDerivatives[j] += derivative;
+			}
+		}
+		else
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+				Simd::axpy(derivatives[i], &layer.weights[i * layer.previousSize], previousDerivatives, layer.previousSize);
+		}
+
+		for (SkipConnection const & c : layer.skipConnections)
+		{
+			if (c.sourceLayer != 0)
+				values[c.sourceLayer].derivativesOfErrorToNetValues[c.sourceIndex] += derivatives[c.destinationIndex] * c.connection->getWeight();
+		}
+	}
+}
+
+void NeuralNetwork::accumulateGradients(std::vector<LayerValues> const & values, std::vector<LayerGradients> & gradients, std::vector<LayerValues> const * previous) const
+{
+	//The derivative of the error with respect to a weight is derivativeOfErrorToNet(destination) * output(source), see Connection::updateWeight()
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		Layer const & layer = _layers[l];
+		LayerGradients & layerGradients = gradients[l];
+		float const * inputs = values[l-1].outputValues.data();
+		float const * derivatives = values[l].derivativesOfErrorToNetValues.data();
+
+		if (layer.sparse)
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+			{
+				float * row = &layerGradients.weights[i * layer.previousSize];
+				
+				for (unsigned k=layer.rowOffsets[i] ; k<layer.rowOffsets[i+1] ; k++)
+					row[layer.columns[k]] += derivatives[i] * inputs[layer.columns[k]];
+			}
+		}
+		else
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+				Simd::axpy(derivatives[i], inputs, &layerGradients.weights[i * layer.previousSize], layer.previousSize);
+		}
+
+		for (unsigned k=0 ; k<layer.skipConnections.size() ; k++)
+		{
+			SkipConnection const & c = layer.skipConnections[k];
+			layerGradients.skipConnections[k] += derivatives[c.destinationIndex] * values[c.sourceLayer].outputValues[c.sourceIndex];
+		}
+
+		if (layer.isRecurrent() && previous)
+		{
+			float const * state = (*previous)[l].outputValues.data();
+
+			for (unsigned i=0 ; i<layer.size ; i++)
+				Simd::axpy(derivatives[i], state, &layerGradients.recurrentWeights[i * layer.size], layer.size);
+		}
+	}
+}
+
+Optimizer::Step NeuralNetwork::nextStep()
+{
+	return _optimizer.getStep(++_numberOfSteps, _learningRateFactor);
+}
+
+void NeuralNetwork::updateWeights(std::vector<LayerGradients> & gradients, Optimizer::Step const & step)
+{
+	//Gradients are summed over the batch (not averaged) so that the learning rate keeps the same meaning whatever the batch size
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		Layer & layer = _layers[l];
+		LayerGradients & g = gradients[l];
+
+		if (layer.sparse)
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+			{
+				for (unsigned k=layer.rowOffsets[i] ; k<layer.rowOffsets[i+1] ; k++)
+				{
+					const unsigned w = i * layer.previousSize + layer.columns[k];
+					_optimizer.update(step, &layer.weights[w], &layer.learningRates[w], &g.weights[w],
+					                  getState(_firstStates, l, &LayerGradients::weights, w), getState(_secondStates, l, &LayerGradients::weights, w), 1);
+				}
+			}
+		}
+		else
+		{
+			_optimizer.update(step, layer.weights, layer.learningRates, g.weights.data(),
+			                  getState(_firstStates, l, &LayerGradients::weights, 0), getState(_secondStates, l, &LayerGradients::weights, 0), layer.getNumberOfWeights());
+		}
+
+		for (unsigned k=0 ; k<layer.skipConnections.size() ; k++)
+		{
+			Connection * c = layer.skipConnections[k].connection;
+			float weight = c->getWeight();
+			const float learningRate = c->getLearningRate();
+
+			_optimizer.update(step, &weight, &learningRate, &g.skipConnections[k],
+			                  getState(_firstStates, l, &LayerGradients::skipConnections, k), getState(_secondStates, l, &LayerGradients::skipConnections, k), 1);
+			c->setWeight(weight);
+		}
+
+		if (layer.isRecurrent())
+		{
+			_optimizer.update(step, layer.recurrentWeights, layer.recurrentLearningRates, g.recurrentWeights.data(),
+			                  getState(_firstStates, l, &LayerGradients::recurrentWeights, 0), getState(_secondStates, l, &LayerGradients::recurrentWeights, 0), layer.getNumberOfRecurrentWeights());
+		}
+	}
+}
+
+void NeuralNetwork::updateWeights(std::vector<LayerValues> const & values)
+{
+	//Online update straight from the values of one learning point, without going through the gradient buffers (the factor of the schedule scales the derivatives)
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		Layer & layer = _layers[l];
+		float const * inputs = values[l-1].outputValues.data();
+		float const * derivatives = values[l].derivativesOfErrorToNetValues.data();
+		
+		for (unsigned i=0 ; i<layer.size ; i++)
+		{
+			const unsigned offset = i * layer.previousSize;
+			const float derivative = _learningRateFactor * derivatives[i];
+			
+			if (layer.sparse)
+			{
+				for (unsigned k=layer.rowOffsets[i] ; k<layer.rowOffsets[i+1] ; k++)
+					layer.weights[offset + layer.columns[k]] -= layer.learningRates[offset + layer.columns[k]] * (derivative * inputs[layer.columns[k]]);
+			}
+			else
+			{
+				Simd::subtractScaledProduct(&layer.weights[offset], &layer.learningRates[offset], derivative, inputs, layer.previousSize);
+			}
+		}
+		
+		for (SkipConnection const & c : layer.skipConnections)
+		{
+			const float variation = _learningRateFactor * derivatives[c.destinationIndex] * values[c.sourceLayer].outputValues[c.sourceIndex];
+			c.connection->setWeight(c.connection->getWeight() - c.connection->getLearningRate() * variation);
+		}
+	}
+}
+
+void NeuralNetwork::updateWeights(unsigned slice, unsigned numberOfSlices, Optimizer::Step const & step, double * squaredGradientNorm)
+{
+	//Same as updateWeights() but the gradients are first summed over all the workspaces, and only one slice of each layer is handled
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		Layer & layer = _layers[l];
+		
+		if (layer.sparse)
+			updateSparseWeights(l, slice, numberOfSlices, step, squaredGradientNorm);
+		else
+			updateDenseWeights(l, slice, numberOfSlices, step, squaredGradientNorm);
+		
+		if (slice != 0)
+			continue;
+		
+		for (unsigned k=0 ; k<layer.skipConnections.size() ; k++)
+		{
+			float gradient = 0.f;
+
+			for (Workspace & workspace : _workspaces)
+			{
+				gradient += workspace.gradients[l].skipConnections[k];
+				workspace.gradients[l].skipConnections[k] = 0.f;
+			}
+
+			if (squaredGradientNorm)
+				*squaredGradientNorm += gradient * gradient;
+
+			Connection * c = layer.skipConnections[k].connection;
+			float weight = c->getWeight();
+			const float learningRate = c->getLearningRate();
+
+			_optimizer.update(step, &weight, &learningRate, &gradient,
+			                  getState(_firstStates, l, &LayerGradients::skipConnections, k), getState(_secondStates, l, &LayerGradients::skipConnections, k), 1);
+			c->setWeight(weight);
+		}
+	}
+}
+
+void NeuralNetwork::updateDenseWeights(unsigned l, unsigned slice, unsigned numberOfSlices, Optimizer::Step const & step, double * squaredGradientNorm)
+{
+	Layer & layer = _layers[l];
+	const unsigned begin = layer.getNumberOfWeights() * slice / numberOfSlices;
+	const unsigned end = layer.getNumberOfWeights() * (slice+1) / numberOfSlices;
+
+	//The gradients are summed into the first workspace (in the same order as a scalar sum)
+	float * gradients = &_workspaces.front().gradients[l].weights[begin];
+
+	for (unsigned w=1 ; w<_workspaces.size() ; w++)
+	{
+		float * workspaceGradients = &_workspaces[w].gradients[l].weights[begin];
+		Simd::axpy(1.f, workspaceGradients, gradients, end - begin);
+		std::fill(workspaceGradients, workspaceGradients + (end - begin), 0.f);
+	}
+
+	if (squaredGradientNorm)
+		*squaredGradientNorm += Simd::dot(gradients, gradients, end - begin);
+
+	_optimizer.update(step, &layer.weights[begin], &layer.learningRates[begin], gradients,
+	                  getState(_firstStates, l, &LayerGradients::weights, begin), getState(_secondStates, l, &LayerGradients::weights, begin), end - begin);
+}
+
+void NeuralNetwork::updateSparseWeights(unsigned l, unsigned slice, unsigned numberOfSlices, Optimizer::Step const & step, double * squaredGradientNorm)
+{
+	//A sparse layer is sliced by rows, only the gradients of its connections are summed
+	Layer & layer = _layers[l];
+	const unsigned begin = layer.size * slice / numberOfSlices;
+	const unsigned end = layer.size * (slice+1) / numberOfSlices;
+	
+	for (unsigned i=begin ; i<end ; i++)
+	{
+		for (unsigned k=layer.rowOffsets[i] ; k<layer.rowOffsets[i+1] ; k++)
+		{
+			const unsigned w = i * layer.previousSize + layer.columns[k];
+			float gradient = 0.f;
+			
+			for (Workspace & workspace : _workspaces)
+			{
+				gradient += workspace.gradients[l].weights[w];
+				workspace.gradients[l].weights[w] = 0.f;
+			}
+			
+			if (squaredGradientNorm)
+				*squaredGradientNorm += gradient * gradient;
+			
+			_optimizer.update(step, &layer.weights[w], &layer.learningRates[w], &gradient,
+			                  getState(_firstStates, l, &LayerGradients::weights, w), getState(_secondStates, l, &LayerGradients::weights, w), 1);
+		}
+	}
+}
+
+void NeuralNetwork::addGradientNorm(std::vector<LayerGradients> const & gradients)
+{
+	//The matrices are dense, so the gradients of the missing connections (whose learning rate is null) are counted too
+	double squaredNorm = 0.;
+	
+	for (LayerGradients const & layerGradients : gradients)
+	{
+		squaredNorm += Simd::dot(layerGradients.weights.data(), layerGradients.weights.data(), layerGradients.weights.size());
+		squaredNorm += Simd::dot(layerGradients.recurrentWeights.data(), layerGradients.recurrentWeights.data(), layerGradients.recurrentWeights.size());
+		
+		for (float gradient : layerGradients.skipConnections)
+			squaredNorm += gradient * gradient;
+	}
+	
+	_statistics.gradientNorm += std::sqrt(squaredNorm);
+	_statistics.numberOfUpdates++;
+}
+
+double NeuralNetwork::getSquaredGradientNorm(std::vector<LayerValues> const & values) const
+{
+	//The gradient of a weight matrix for one learning point is the outer product of the derivatives and the inputs, its norm is the product of their norms
+	double squaredNorm = 0.;
+	
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		Layer const & layer = _layers[l];
+		float const * inputs = values[l-1].outputValues.data();
+		float const * derivatives = values[l].derivativesOfErrorToNetValues.data();
+		
+		if (layer.sparse)
+		{
+			for (unsigned i=0 ; i<layer.size ; i++)
+				for (unsigned k=layer.rowOffsets[i] ; k<layer.rowOffsets[i+1] ; k++)
+					squaredNorm += std::pow(derivatives[i] * inputs[layer.columns[k]], 2);
+		}
+		else
+		{
+			squaredNorm += static_cast<double>(Simd::dot(derivatives, derivatives, layer.size)) * Simd::dot(inputs, inputs, layer.previousSize);
+		}
+		
+		for (SkipConnection const & c : layer.skipConnections)
+			squaredNorm += std::pow(derivatives[c.destinationIndex] * values[c.sourceLayer].outputValues[c.sourceIndex], 2);
+	}
+	
+	return squaredNorm;
+}
+
+void NeuralNetwork::compileSparseLayers()
+{
+	if (!_sparseLayersOutdated)
+		return;
+	
+	for (Layer & layer : _layers)
+		layer.compileSparse(_sparseThreshold);
+	
+	_sparseLayersOutdated = false;
+}
+
+float NeuralNetwork::drawWeight()
+{
+	//The 24 high bits of the generator give every float of the interval the same probability, unlike rand() and the distributions of the standard library, whose results depend on the implementation
+	return static_cast<float>(_generator() >> 8) / 16777216.f - 0.5f;
+}
+
+unsigned NeuralNetwork::drawIndex(unsigned n)
+{
+	//Multiply-shift reduction of a 32-bit number (the bias is below n / 2^32)
+	return static_cast<unsigned>((static_cast<uint64_t>(_generator()) * n) >> 32);
+}
+
+void NeuralNetwork::shuffle(std::vector<unsigned> & indices)
+{
+	for (unsigned i=indices.size() ; i>1 ; i--)
+		std::swap(indices[i-1], indices[drawIndex(i)]);
+}
+
+void NeuralNetwork::shuffleSequences()
+{
+	//The sequences are permuted like the points, then the index array is rebuilt one whole sequence after the other
+	std::vector<unsigned> & indices = _learningSet.getIndices();
+	std::vector<unsigned> & order = _shuffledSequenceLengths;
+	
+	_sequenceStarts.resize(_sequenceLengths.size());
+	order.resize(_sequenceLengths.size());
+	
+	for (unsigned s=0, start=0 ; s<_sequenceLengths.size() ; start+=_sequenceLengths[s], s++)
+	{
+		_sequenceStarts[s] = start;
+		order[s] = s;
+	}
+	
+	shuffle(order);
+	_shuffledIndices.clear();
+	
+	for (unsigned & s : order)
+	{
+		_shuffledIndices.insert(_shuffledIndices.end(), indices.begin() + _sequenceStarts[s], indices.begin() + _sequenceStarts[s] + _sequenceLengths[s]);
+		s = _sequenceLengths[s];
+	}
+	
+	indices.swap(_shuffledIndices);
+	_sequenceLengths.swap(order);
+}
+
+bool NeuralNetwork::hasRecurrentLayers() const
+{
+	for (Layer const & layer : _layers)
+	{
+		if (layer.isRecurrent())
+			return true;
+	}
+	
+	return false;
+}
+
+unsigned NeuralNetwork::getNumberOfWeights() const
+{
+	unsigned numberOfWeights = getNumberOfMatrixWeights() + getNumberOfRecurrentWeights();
+	
+	for (Layer const & layer : _layers)
+		numberOfWeights += layer.skipConnections.size();
+	
+	return numberOfWeights;
+}
+
+void NeuralNetwork::getWeights(float * weights) const
+{
+	for (Layer const & layer : _layers)
+		weights = std::copy(layer.weights, layer.weights + layer.getNumberOfWeights(), weights);
+	
+	for (Layer const & layer : _layers)
+		for (SkipConnection const & c : layer.skipConnections)
+			*weights++ = c.connection->getWeight();
+	
+	for (Layer const & layer : _layers)
+		weights = std::copy(layer.recurrentWeights, layer.recurrentWeights + layer.getNumberOfRecurrentWeights(), weights);
+}
+
+void NeuralNetwork::setWeights(float const * weights)
+{
+	//The positions without a connection must stay null, they are skipped
+	for (Layer & layer : _layers)
+	{
+		for (unsigned k=0 ; k<layer.getNumberOfWeights() ; k++)
+		{
+			if (layer.hasConnection(k))
+				layer.weights[k] = weights[k];
+		}
+		
+		weights += layer.getNumberOfWeights();
+	}
+	
+	for (Layer & layer : _layers)
+		for (SkipConnection & c : layer.skipConnections)
+			c.connection->setWeight(*weights++);
+	
+	for (Layer & layer : _layers)
+	{
+		std::copy(weights, weights + layer.getNumberOfRecurrentWeights(), layer.recurrentWeights);
+		weights += layer.getNumberOfRecurrentWeights();
+	}
+}
+
+unsigned NeuralNetwork::getNumberOfMatrixWeights() const
+{
+	unsigned numberOfWeights = 0;
+	
+	for (Layer const & layer : _layers)
+		numberOfWeights += layer.getNumberOfWeights();
+	
+	return numberOfWeights;
+}
+
+unsigned NeuralNetwork::getNumberOfRecurrentWeights() const
+{
+	unsigned numberOfWeights = 0;
+	
+	for (Layer const & layer : _layers)
+		numberOfWeights += layer.getNumberOfRecurrentWeights();
+	
+	return numberOfWeights;
+}
+
+std::string NeuralNetwork::toString() const
+{
+	std::stringstream ss;
+	buildConnectionViews();
+	
+	for (auto neuron = _neurons.back().begin() ; neuron != _neurons.back().end() ; neuron++)
+	{
+		ss << neuron->toString();
+		if (neuron != std::prev(_neurons.back().end()))
+			ss << " + ";
+	}
+	
+	return ss.str();
+}
+
+bool NeuralNetwork::save(std::string const & fileName) const
+{
+	std::vector<char> buffer;
+	return serialize(buffer) && writeFile(fileName, buffer);
+}
+
+bool NeuralNetwork::writeFile(std::string const & fileName, std::vector<char> const & buffer)
+{
+	std::ofstream file(fileName, std::ios::binary);
+	file.write(buffer.data(), buffer.size());
+
+	if (!file.good())
+	{
+		ERROR_MSG("Cannot write file " << fileName);
+		return false;
+	}
+
+	return true;
+}
+
+bool NeuralNetwork::serialize(std::vector<char> & buffer) const
+{
+	if (_layers.empty())
+	{
+		ERROR_MSG("Cannot save a network without layers");
+		return false;
+	}
+
+	std::vector<uint32_t> layerSizes;
+	for (Layer const & layer : _layers)
+		layerSizes.push_back(layer.size);
+
+	//The matrices cannot tell which connections exist (a connection may have a null weight and learning rate), so the bitmaps of the layers are saved with them
+	std::vector<ModelFile::SkipConnectionRecord> skipConnections;
+
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		for (SkipConnection const & c : _layers[l].skipConnections)
+			skipConnections.push_back({c.sourceLayer, c.sourceIndex, l, c.destinationIndex, c.connection->getWeight(), c.connection->getLearningRate()});
+	}
+
+	std::vector<uint32_t> recurrentLayers;
+	for (Layer const & layer : _layers)
+		recurrentLayers.push_back(layer.isRecurrent());
+
+	ModelFile::Layout layout(layerSizes, skipConnections.size(), ModelFile::Version, recurrentLayers);
+	buffer.assign(layout.fileSize, 0);
+
+	ModelFile::Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, ModelFile::Magic, sizeof(header.magic));
+	header.version = ModelFile::Version;
+	header.byteOrderMark = ModelFile::ByteOrderMark;
+	header.numberOfLayers = layerSizes.size();
+	header.loss = static_cast<uint32_t>(_loss);
+	header.numberOfSkipConnections = skipConnections.size();
+	header.fileSize = layout.fileSize;
+
+	std::memcpy(&buffer[0], &header, sizeof(header));
+	std::memcpy(&buffer[layout.layerSizes], layerSizes.data(), layerSizes.size() * sizeof(uint32_t));
+
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		std::memcpy(&buffer[layout.weights[l]], _layers[l].weights, _layers[l].getNumberOfWeights() * sizeof(float));
+		std::memcpy(&buffer[layout.learningRates[l]], _layers[l].learningRates, _layers[l].getNumberOfWeights() * sizeof(float));
+		std::memcpy(&buffer[layout.connections[l]], _layers[l].connections, _layers[l].getConnectionBitmapSize());
+	}
+
+	for (unsigned l=0 ; l<_layers.size() ; l++)
+		std::memcpy(&buffer[layout.outputValues[l]], _values[l].outputValues.data(), _layers[l].size * sizeof(float));
+
+	if (!skipConnections.empty())
+		std::memcpy(&buffer[layout.skipConnections], skipConnections.data(), skipConnections.size() * sizeof(ModelFile::SkipConnectionRecord));
+
+	for (unsigned l=0 ; l<_layers.size() ; l++)
+	{
+		const uint32_t activation = static_cast<uint32_t>(_layers[l].activation);
+		std::memcpy(&buffer[layout.activations + l * sizeof(uint32_t)], &activation, sizeof(activation));
+	}
+
+	std::memcpy(&buffer[layout.recurrentLayers], recurrentLayers.data(), recurrentLayers.size() * sizeof(uint32_t));
+
+	for (unsigned l=0 ; l<_layers.size() ; l++)
+	{
+		if (!_layers[l].isRecurrent())
+			continue;
+
+		std::memcpy(&buffer[layout.recurrentWeights[l]], _layers[l].recurrentWeights, _layers[l].getNumberOfRecurrentWeights() * sizeof(float));
+		std::memcpy(&buffer[layout.recurrentLearningRates[l]], _layers[l].recurrentLearningRates, _layers[l].getNumberOfRecurrentWeights() * sizeof(float));
+	}
+
+	return true;
+}
+
+bool NeuralNetwork::load(std::string const & fileName)
+{
+	if (!_layers.empty())
+	{
+		ERROR_MSG("Cannot load a model into a network which already has layers");
+		return false;
+	}
+
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(fileName);
+
+	if (!file->isOpen())
+		return false;
+
+	return load(file, fileName);
+}
+
+bool NeuralNetwork::load(std::shared_ptr<MappedFile> file, std::string const & fileName)
+{
+	char * data = file->getData();
+	ModelFile::Header header;
+
+	if (file->getSize() < sizeof(header))
+	{
+		ERROR_MSG("File " << fileName << " is too small to be a model file");
+		return false;
+	}
+
+	std::memcpy(&header, data, sizeof(header));
+
+	if (std::memcmp(header.magic, ModelFile::Magic, sizeof(header.magic)) != 0)
+	{
+		ERROR_MSG("File " << fileName << " is not a model file");
+		return false;
+	}
+
+	if (header.byteOrderMark != ModelFile::ByteOrderMark || header.version == 0 || header.version > ModelFile::Version)
+	{
+		ERROR_MSG("Model file " << fileName << " has version " << header.version << " or a byte order which is not supported");
+		return false;
+	}
+
+	if (header.fileSize != file->getSize() || header.numberOfLayers == 0 || ModelFile::align(sizeof(header)) + header.numberOfLayers * sizeof(uint32_t) > file->getSize())
+	{
+		ERROR_MSG("Model file " << fileName << " is truncated or corrupted");
+		return false;
+	}
+
+	//The matrices are used in place, so they must be correctly aligned in memory (the offsets inside the file are)
+	if (reinterpret_cast<uintptr_t>(data) % ModelFile::Alignment != 0)
+	{
+		ERROR_MSG("Model file " << fileName << " is not mapped on an aligned address");
+		return false;
+	}
+
+	std::vector<uint32_t> layerSizes(header.numberOfLayers);
+	std::memcpy(layerSizes.data(), data + ModelFile::align(sizeof(header)), layerSizes.size() * sizeof(uint32_t));
+
+	//The sections of the recurrent matrices depend on the recurrent flags, which are at the same place whatever the flags
+	std::vector<uint32_t> recurrentLayers(layerSizes.size(), 0);
+
+	if (header.version >= 3)
+	{
+		ModelFile::Layout flagsLayout(layerSizes, header.numberOfSkipConnections, header.version);
+
+		if (flagsLayout.fileSize > header.fileSize)
+		{
+			ERROR_MSG("Model file " << fileName << " is truncated or corrupted");
+			return false;
+		}
+
+		std::memcpy(recurrentLayers.data(), data + flagsLayout.recurrentLayers, recurrentLayers.size() * sizeof(uint32_t));
+
+		for (unsigned l=0 ; l<layerSizes.size() ; l++)
+		{
+			if (recurrentLayers[l] > 1 || (recurrentLayers[l] && (l == 0 || l + 1 == layerSizes.size())))
+			{
+				ERROR_MSG("Model file " << fileName << " contains an invalid recurrent layer");
+				return false;
+			}
+		}
+	}
+
+	ModelFile::Layout layout(layerSizes, header.numberOfSkipConnections, header.version, recurrentLayers);
+
+	if (layout.fileSize != header.fileSize)
+	{
+		ERROR_MSG("Model file " << fileName << " has a size which does not match its layers");
+		return false;
+	}
+
+	ModelFile::SkipConnectionRecord const * skipConnections = reinterpret_cast<ModelFile::SkipConnectionRecord const *>(data + layout.skipConnections);
+
+	for (uint64_t k=0 ; k<header.numberOfSkipConnections ; k++)
+	{
+		ModelFile::SkipConnectionRecord const & c = skipConnections[k];
+
+		if (c.destinationLayer >= layerSizes.size() || c.sourceLayer + 1 >= c.destinationLayer || c.sourceIndex >= layerSizes[c.sourceLayer] || c.destinationIndex >= layerSizes[c.destinationLayer])
+		{
+			ERROR_MSG("Model file " << fileName << " contains an invalid connection");
+			return false;
+		}
+	}
+
+	std::vector<uint32_t> activations(layerSizes.size(), static_cast<uint32_t>(Activation::Tanh));
+	
+	if (header.version >= 2)
+		std::memcpy(activations.data(), data + layout.activations, activations.size() * sizeof(uint32_t));
+	
+	for (uint32_t activation : activations)
+	{
+		if (activation > static_cast<uint32_t>(Activation::Softmax) || header.loss > static_cast<uint32_t>(Loss::CrossEntropy))
+		{
+			ERROR_MSG("Model file " << fileName << " contains an unknown activation function or loss");
+			return false;
+		}
+	}
+
+	//Everything has been checked, build the network on top of the mapped matrices and bitmaps (the layers count the inputs of their neurons in the bitmaps)
+	_mappedFile = file;
+	_connectionViewsBuilt = false;
+
+	for (unsigned l=0 ; l<layerSizes.size() ; l++)
+	{
+		if (l == 0)
+			addLayer(layerSizes[l], nullptr, nullptr, nullptr);
+		else
+			addLayer(layerSizes[l], reinterpret_cast<float *>(data + layout.weights[l]), reinterpret_cast<float *>(data + layout.learningRates[l]), reinterpret_cast<uint8_t *>(data + layout.connections[l]));
+	}
+
+	for (unsigned l=0 ; l<_layers.size() ; l++)
+	{
+		_layers[l].activation = static_cast<Activation>(activations[l]);
+
+		if (recurrentLayers[l])
+			_layers[l].makeRecurrent(reinterpret_cast<float *>(data + layout.recurrentWeights[l]), reinterpret_cast<float *>(data + layout.recurrentLearningRates[l]));
+	}
+
+	_loss = static_cast<Loss>(header.loss);
+
+	//Only the connections between non adjacent layers need objects right away, they hold their weights
+	for (uint64_t k=0 ; k<header.numberOfSkipConnections ; k++)
+	{
+		ModelFile::SkipConnectionRecord const & c = skipConnections[k];
+		ConnectionPtr connection = _connections.create(&_neurons[c.sourceLayer][c.sourceIndex], &_neurons[c.destinationLayer][c.destinationIndex], nullptr, nullptr, false);
+
+		connection->setWeight(c.weight);
+		connection->setLearningRate(c.learningRate);
+		_layers[c.destinationLayer].addSkipConnection(c.sourceLayer, c.sourceIndex, c.destinationIndex, connection);
+		_layers[c.destinationLayer].numberOfInputs[c.destinationIndex]++;
+	}
+
+	//Hidden neurons without inputs are bias neurons
+	for (std::vector<Neuron> & layer : _neurons)
+	{
+		for (Neuron & neuron : layer)
+			neuron.updateType();
+	}
+
+	//Bias neurons get their saved value back
+	for (unsigned l=1 ; l<_layers.size() ; l++)
+	{
+		float const * outputValues = reinterpret_cast<float const *>(data + layout.outputValues[l]);
+
+		for (unsigned i=0 ; i<_layers[l].size ; i++)
+		{
+			if (_layers[l].numberOfInputs[i] == 0)
+				_values[l].outputValues[i] = outputValues[i];
+		}
+	}
+
+	compileSparseLayers();
+	return true;
+}
@@ -4,36 +4,53 @@
 
 using namespace ENN;
 
-Neuron::Neuron(NeuralNetwork * network)
- : _network(network)
+Neuron::Neuron(NeuralNetwork * network, LayerValues & values, unsigned layer, unsigned index)
+ : _network(network), _layer(layer), _index(index)
 {
 	_inputNeurons.clear();
 	_outputNeurons.clear();
 	
-	_netValue = 0.f;
-	_outputValue = 0.f;
-	_derivativeOfErrorToNetValue = 0.f;
+	_netValue = &values.netValues[index];
+	_outputValue = &values.outputValues[index];
+	_desiredOutput = &values.desiredOutputValues[index];
+	_derivativeOfErrorToNetValue = &values.derivativesOfErrorToNetValues[index];
+	
+	//A new neuron always belongs to the last layer
+	_type = (layer == 0) ? Neuron::Type::Input : Neuron::Type::Output;
 }
 
 Neuron::Type Neuron::getType() const
 {
-	std::pair<unsigned, unsigned> position = _network->getNeuronPosition(this);
-	
-	if (position.first == 0)
-		return Neuron::Type::Input;
-	
-	if (position.first == _network->getNumberOfLayers() - 1)
-		return Neuron::Type::Output;
-		
-	if (getNumberOfInputs() == 0)
-		return Neuron::Type::Bias;
-		
-	return Neuron::Type::Hidden;
+	return _type;
+}
+
+unsigned Neuron::getLayer() const
+{
+	return _layer;
+}
+
+unsigned Neuron::getIndex() const
+{
+	return _index;
+}
+
+void Neuron::updateType()
+{
+	//Called whenever the type may change: when a layer is added after this one and when an input is added
+	if (_layer == 0)
+		_type = Neuron::Type::Input;
+	else if (_layer == _network->getNumberOfLayers() - 1)
+		_type = Neuron::Type::Output;
+	else if (getNumberOfInputs() == 0)
+		_type = Neuron::Type::Bias;
+	else
+		_type = Neuron::Type::Hidden;
 }
 
 void Neuron::addInput(ConnectionPtr connection)
 {
 	_inputNeurons.push_back(connection);
+	updateType();
 }
 
 void Neuron::addOutput(ConnectionPtr connection)
@@ -43,7 +60,8 @@ void Neuron::addOutput(ConnectionPtr connection)
 
 unsigned Neuron::getNumberOfInputs() const
 {
-	return _inputNeurons.size();
+	//Also right before the connection lists of a loaded network are built
+	return _network->_layers[_layer].numberOfInputs[_index];
 }
 
 unsigned Neuron::getNumberOfOutputs() const
@@ -53,32 +71,18 @@ unsigned Neuron::getNumberOfOutputs() const
 
 bool Neuron::connectedToDestination(Neuron const * const destination) const
 {
-	bool result = false;
-	
-	for (ConnectionPtr c : _outputNeurons)
-	{
-		if (c->getDestination() == destination)
-		{
-			result = true;
-			break;
-		}
-	}
-		
-	return result;
+	return _network->connectionExists(_layer, _index, destination->_layer, destination->_index);
 }
 
 void Neuron::setConnectionWeight(Neuron * destination, float newWeight)
 {
-	for (ConnectionPtr c : _outputNeurons)
+	if (!connectedToDestination(destination))
 	{
-		if (c->getDestination() == destination)
-		{
-			c->setWeight(newWeight);
-			return;
-		}
+		ERROR_MSG("Cannot change connection weight because connection can not be found");
+		return;
 	}
 	
-	ERROR_MSG("Cannot change connection weight because connection can not be found");
+	_network->setConnectionWeight(_layer, _index, destination->_layer, destination->_index, newWeight);
 }
 
 void Neuron::compute()
@@ -88,23 +92,34 @@ void Neuron::compute()
 		return;
 	
 	//Compute net value
-	_netValue = 0.f;
+	*_netValue = 0.f;
 	
-	for (ConnectionPtr c : _inputNeurons)
-		_netValue += c->getSource()->getOutputValue() * c->getWeight();
+	for (ConnectionPtr const & c : _inputNeurons)
+		*_netValue += c->getSource()->getOutputValue() * c->getWeight();
 	
 	//Compute output value
-	_outputValue = tanh(_netValue);
+	Layer const & layer = _network->_layers[_layer];
+	
+	if (layer.activation == Activation::Softmax)
+	{
+		//The outputs depend on the net values of the whole layer, they are right once all the neurons of the layer have been computed
+		LayerValues & values = _network->_values[_layer];
+		Activations::softmax(values.netValues.data(), values.outputValues.data(), layer.numberOfInputs.data(), layer.size, 1);
+	}
+	else
+	{
+		*_outputValue = Activations::activate(layer.activation, *_netValue);
+	}
 }
 
 float Neuron::getOutputValue() const
 {
-	return _outputValue;
+	return *_outputValue;
 }
 
 float Neuron::getNetValue() const
 {
-	return _netValue;
+	return *_netValue;
 }
 
 void Neuron::setOutputValue(float outputValue)
@@ -115,7 +130,7 @@ void Neuron::setOutputValue(float outputValue)
 		return;
 	}
 	
-	_outputValue = outputValue;
+	*_outputValue = outputValue;
 }
 
 void Neuron::setDesiredOutputValue(float desiredOutputValue)
@@ -126,29 +141,53 @@ void Neuron::setDesiredOutputValue(float desiredOutputValue)
 		return;
 	}
 	
-	_desiredOutput = desiredOutputValue;
+	*_desiredOutput = desiredOutputValue;
 }
 		
 void Neuron::computeDerativeOfErrorToNetValue()
 {
-	if (getType() == Neuron::Type::Output) //Output neuron, simple case
+	Layer const & layer = _network->_layers[_layer];
+	
+	if (getType() == Neuron::Type::Output && _network->getLoss() == Loss::CrossEntropy) //The derivative of the output activation cancels out
 	{
-		_derivativeOfErrorToNetValue = (_outputValue - _desiredOutput) * (1 - pow(tanh(_netValue), 2));
+		*_derivativeOfErrorToNetValue = *_outputValue - *_desiredOutput;
 	}
-	else //Hidden neuron, that's were the backpropagation algorithm kicks in
+	else if (layer.activation == Activation::Softmax) //The output of each neuron of the layer depends on this net value
 	{
-		//The first step is to sum up the derivative of error with respect to the net value of neurons of the next layer, mutliplied by the connections weights
-		for (ConnectionPtr c : _outputNeurons)
-			_derivativeOfErrorToNetValue += c->getDestination()->getDerativeOfErrorToNetValue() * c->getWeight();
-			
-		//The second and last step is to multiply this partial error derivative by the derivative of the activation function applied to the net value
-		_derivativeOfErrorToNetValue *= (1 - pow(tanh(_netValue), 2));
+		float sum = 0.f;
+		unsigned i = 0;
+		
+		for (Neuron const & neuron : _network->_neurons[_layer])
+		{
+			if (layer.numberOfInputs[i++] != 0)
+				sum += neuron.getDerivativeOfErrorToOutputValue() * neuron.getOutputValue();
+		}
+		
+		*_derivativeOfErrorToNetValue = *_outputValue * (getDerivativeOfErrorToOutputValue() - sum);
+	}
+	else
+	{
+		//Multiply the derivative of the error with respect to the output value by the derivative of the activation function, expressed with the output value
+		*_derivativeOfErrorToNetValue = getDerivativeOfErrorToOutputValue() * Activations::derivative(layer.activation, *_outputValue);
 	}
 }
+
+float Neuron::getDerivativeOfErrorToOutputValue() const
+{
+	if (getType() == Neuron::Type::Output) //Output neuron, simple case
+		return *_outputValue - *_desiredOutput;
+	
+	//Hidden neuron, that's were the backpropagation algorithm kicks in: sum up the derivative of error with respect to the net value of neurons of the next layer, mutliplied by the connections weights
+	float derivative = 0.f;
+	for (ConnectionPtr const & c : _outputNeurons)
+		derivative += c->getDestination()->getDerativeOfErrorToNetValue() * c->getWeight();
+	
+	return derivative;
+}
 	
 float Neuron::getDerativeOfErrorToNetValue() const
 {
-	return _derivativeOfErrorToNetValue;
+	return *_derivativeOfErrorToNetValue;
 }
 
 float Neuron::getError() const
@@ -159,7 +198,7 @@ float Neuron::getError() const
 		return 0.f;
 	}
 		
-	return pow(_desiredOutput - _outputValue, 2) / 2.0;
+	return Activations::getError(_network->getLoss(), _network->getActivation(_layer), *_desiredOutput, *_outputValue);
 }
 
 std::string Neuron::toString() const
@@ -168,15 +207,15 @@ std::string Neuron::toString() const
 	
 	if (getType() == Neuron::Type::Bias)
 	{
-		ss << _outputValue;
+		ss << *_outputValue;
 	}
 	else if (getType() == Neuron::Type::Input)
 	{
-		ss << "x" << _network->getNeuronPosition(this).second;
+		ss << "x" << _index;
 	}
 	else
 	{
-		ss << "tanh(";
+		ss << Activations::toString(_network->getActivation(_layer)) << "(";
 
 		for (auto c = _inputNeurons.begin() ; c != _inputNeurons.end() ; c++)
 		{
@@ -0,0 +1,205 @@
+#include "optimizer.hpp"
+#include "simd.hpp"
+
+using namespace ENN;
+
+Optimizer::Optimizer(Method method)
+ : _method(method), _momentum(0.9f), _decay(0.9f), _beta1(0.9f), _beta2(0.999f), _epsilon(1e-8f)
+{
+}
+
+Optimizer::Method Optimizer::getMethod() const
+{
+	return _method;
+}
+
+void Optimizer::setMomentum(float momentum)
+{
+	if (momentum < 0.f || momentum >= 1.f)
+	{
+		ERROR_MSG("Momentum must be in [0, 1)");
+		return;
+	}
+
+	_momentum = momentum;
+}
+
+float Optimizer::getMomentum() const
+{
+	return _momentum;
+}
+
+void Optimizer::setDecay(float decay)
+{
+	if (decay < 0.f || decay >= 1.f)
+	{
+		ERROR_MSG("Decay must be in [0, 1)");
+		return;
+	}
+
+	_decay = decay;
+}
+
+float Optimizer::getDecay() const
+{
+	return _decay;
+}
+
+void Optimizer::setBetas(float beta1, float beta2)
+{
+	if (beta1 < 0.f || beta1 >= 1.f || beta2 < 0.f || beta2 >= 1.f)
+	{
+		ERROR_MSG("The betas of Adam must be in [0, 1)");
+		return;
+	}
+
+	_beta1 = beta1;
+	_beta2 = beta2;
+}
+
+float Optimizer::getBeta1() const
+{
+	return _beta1;
+}
+
+float Optimizer::getBeta2() const
+{
+	return _beta2;
+}
+
+void Optimizer::setEpsilon(float epsilon)
+{
+	if (epsilon <= 0.f)
+	{
+		ERROR_MSG("Epsilon must be positive");
+		return;
+	}
+
+	_epsilon = epsilon;
+}
+
+float Optimizer::getEpsilon() const
+{
+	return _epsilon;
+}
+
+unsigned Optimizer::getNumberOfStates() const
+{
+	switch (_method)
+	{
+		case Method::Momentum:
+		case Method::Nesterov:
+		case Method::RMSProp:
+			return 1;
+		case Method::Adam:
+			return 2;
+		default:
+			return 0;
+	}
+}
+
+Optimizer::Step Optimizer::getStep(unsigned step, float learningRateFactor) const
+{
+	if (_method != Method::Adam)
+		return {learningRateFactor, _epsilon};
+
+	/* Adam divides the mean m and the mean square s of the gradients by their bias corrections c1 and c2 (they start from 0):
+	 * (m / c1) / (sqrt(s / c2) + epsilon) = (sqrt(c2) / c1) * m / (sqrt(s) + epsilon * sqrt(c2)), so the kernel only needs a scale and an epsilon
+	 */
+	const double c1 = 1. - std::pow(static_cast<double>(_beta1), step);
+	const double c2 = 1. - std::pow(static_cast<double>(_beta2), step);
+
+	return {static_cast<float>(learningRateFactor * std::sqrt(c2) / c1), static_cast<float>(_epsilon * std::sqrt(c2))};
+}
+
+void Optimizer::update(Step const & step, float * weights, float const * learningRates, float * gradients, float * firstStates, float * secondStates, unsigned n) const
+{
+	switch (_method)
+	{
+		case Method::Momentum:
+			Simd::momentum(weights, learningRates, gradients, firstStates, _momentum, 0.f, 1.f, step.scale, n);
+			break;
+		case Method::Nesterov:
+			//The step looks ahead along the new velocity: gradient + momentum * velocity
+			Simd::momentum(weights, learningRates, gradients, firstStates, _momentum, 1.f, _momentum, step.scale, n);
+			break;
+		case Method::RMSProp:
+			Simd::rmsProp(weights, learningRates, gradients, firstStates, _decay, step.epsilon, step.scale, n);
+			break;
+		case Method::Adam:
+			Simd::adam(weights, learningRates, gradients, firstStates, secondStates, _beta1, _beta2, step.epsilon, step.scale, n);
+			break;
+		default:
+			//Without schedule this is exactly the historical update
+			if (step.scale == 1.f)
+				Simd::subtractProduct(weights, learningRates, gradients, n);
+			else
+				Simd::subtractScaledProduct(weights, learningRates, step.scale, gradients, n);
+
+			std::fill(gradients, gradients + n, 0.f);
+			break;
+	}
+}
+
+std::string Optimizer::toString(Method method)
+{
+	switch (method)
+	{
+		case Method::Momentum:
+			return "momentum";
+		case Method::Nesterov:
+			return "Nesterov momentum";
+		case Method::RMSProp:
+			return "RMSProp";
+		case Method::Adam:
+			return "Adam";
+		default:
+			return "SGD";
+	}
+}
+
+LearningRateSchedule::~LearningRateSchedule()
+{
+}
+
+StepDecay::StepDecay(unsigned interval, float factor)
+ : _interval(interval), _factor(factor)
+{
+	if (_interval == 0)
+	{
+		WARNING_MSG("A step decay needs an interval of at least one cycle, using one");
+		_interval = 1;
+	}
+}
+
+float StepDecay::getFactor(unsigned cycle) const
+{
+	return std::pow(_factor, static_cast<float>(cycle / _interval));
+}
+
+ExponentialDecay::ExponentialDecay(float factor)
+ : _factor(factor)
+{
+}
+
+float ExponentialDecay::getFactor(unsigned cycle) const
+{
+	return std::pow(_factor, static_cast<float>(cycle));
+}
+
+CosineAnnealing::CosineAnnealing(unsigned numberOfCycles, float minimumFactor, unsigned warmUpCycles)
+ : _numberOfCycles(numberOfCycles), _minimumFactor(minimumFactor), _warmUpCycles(warmUpCycles)
+{
+}
+
+float CosineAnnealing::getFactor(unsigned cycle) const
+{
+	if (cycle < _warmUpCycles)
+		return static_cast<float>(cycle + 1) / (_warmUpCycles + 1);
+
+	//The warm-up cycles count in numberOfCycles
+	const unsigned length = std::max(_numberOfCycles, _warmUpCycles + 1) - _warmUpCycles;
+	const float progress = std::min(static_cast<float>(cycle - _warmUpCycles) / length, 1.f);
+
+	return _minimumFactor + (1.f - _minimumFactor) * 0.5f * (1.f + std::cos(static_cast<float>(M_PI) * progress));
+}
@@ -0,0 +1,307 @@
+#include "quantizedmodel.hpp"
+
+using namespace ENN;
+
+namespace
+{
+	const unsigned blockSize = 64; //Number of samples processed together, like NeuralNetwork::processBatch()
+	const float maximumQuantizedValue = 127.f; //Symmetric range, so that -value is always representable
+}
+
+QuantizationReport::QuantizationReport()
+ : numberOfPoints(0), maximumDifference(0.f), meanDifference(0.f), floatError(0.f), quantizedError(0.f)
+{
+}
+
+QuantizedModel::QuantizedModel(NeuralNetwork & network, Precision precision, LearningSet const & calibrationSet)
+ : _precision(precision), _quantized(false), _loss(network.getLoss()), _fastActivation(network.getFastActivation())
+{
+	if (network.getNumberOfLayers() < 2)
+	{
+		ERROR_MSG("Cannot quantize a network without at least two layers");
+		return;
+	}
+
+	if (network.hasRecurrentLayers())
+	{
+		ERROR_MSG("Recurrent networks cannot be quantized");
+		return;
+	}
+
+	if (precision == Precision::Int8 && calibrationSet.empty())
+	{
+		ERROR_MSG("Int8 quantization needs a calibration set to choose the scale of the values of each layer");
+		return;
+	}
+
+	for (LearningPoint const & point : calibrationSet)
+	{
+		if (point.first.size() != network.getNumberOfNeuronsOnLayer(0))
+		{
+			ERROR_MSG("Calibration vector of size " << point.first.size() << " does not match the number of input neurons");
+			return;
+		}
+	}
+
+	//The range of the values of each layer is measured on the calibration set, with the float network
+	std::vector<float> maximumValues(network._layers.size(), 0.f);
+	std::vector<LayerValues> values = network._values;
+	network.compileSparseLayers();
+
+	for (LearningPoint const & point : calibrationSet)
+	{
+		network.process(point.first.data(), values);
+
+		for (unsigned l=0 ; l<values.size() ; l++)
+		{
+			for (float value : values[l].outputValues)
+				maximumValues[l] = std::max(maximumValues[l], std::fabs(value));
+		}
+	}
+
+	for (unsigned l=0 ; l<network._layers.size() ; l++)
+	{
+		Layer const & layer = network._layers[l];
+		QuantizedLayer quantizedLayer;
+
+		quantizedLayer.size = layer.size;
+		quantizedLayer.previousSize = layer.previousSize;
+		quantizedLayer.activation = layer.activation;
+		quantizedLayer.numberOfInputs = layer.numberOfInputs;
+		quantizedLayer.biasValues = network._values[l].outputValues;
+		quantizedLayer.scale = 1.f;
+		quantizedLayer.inputScale = 1.f;
+
+		for (SkipConnection const & c : layer.skipConnections)
+			quantizedLayer.skipConnections.push_back({c.sourceLayer, c.sourceIndex, c.destinationIndex, c.connection->getWeight()});
+
+		if (precision == Precision::Int8 && l != 0)
+		{
+			//Symmetric quantization: the largest weight (and the largest value seen during the calibration) becomes +-127
+			float maximumWeight = 0.f;
+
+			for (unsigned k=0 ; k<layer.getNumberOfWeights() ; k++)
+				maximumWeight = std::max(maximumWeight, std::fabs(layer.weights[k]));
+
+			const float weightScale = maximumWeight > 0.f ? maximumWeight / maximumQuantizedValue : 1.f;
+			quantizedLayer.inputScale = maximumValues[l-1] > 0.f ? maximumValues[l-1] / maximumQuantizedValue : 1.f;
+			quantizedLayer.scale = weightScale * quantizedLayer.inputScale;
+			quantizedLayer.weights.resize(layer.getNumberOfWeights());
+
+			for (unsigned k=0 ; k<layer.getNumberOfWeights() ; k++)
+				quantizedLayer.weights[k] = static_cast<int8_t>(std::round(layer.weights[k] / weightScale));
+		}
+		else if (precision == Precision::Float16)
+		{
+			quantizedLayer.halfWeights.resize(layer.getNumberOfWeights());
+			Simd::toHalf(layer.weights, quantizedLayer.halfWeights.data(), layer.getNumberOfWeights());
+		}
+
+		_layers.push_back(std::move(quantizedLayer));
+		_values.emplace_back(static_cast<std::size_t>(layer.size) * blockSize);
+	}
+
+	_quantized = true;
+}
+
+bool QuantizedModel::isQuantized() const
+{
+	return _quantized;
+}
+
+QuantizedModel::Precision QuantizedModel::getPrecision() const
+{
+	return _precision;
+}
+
+std::size_t QuantizedModel::getMemorySize() const
+{
+	std::size_t size = 0;
+
+	for (QuantizedLayer const & layer : _layers)
+		size += layer.weights.size() * sizeof(int8_t) + layer.halfWeights.size() * sizeof(uint16_t) + layer.skipConnections.size() * sizeof(QuantizedSkipConnection);
+
+	return size;
+}
+
+LearningVector QuantizedModel::process(LearningVector const & inputs)
+{
+	if (!_quantized || inputs.size() != _layers.front().size)
+	{
+		ERROR_MSG("Input learning vector size (" << inputs.size() << ") and number of input neurons are not equal, or the model is not quantized");
+		return LearningVector();
+	}
+
+	LearningVector outputs(_layers.back().size);
+	processBatch(inputs.data(), 1, outputs.data());
+	return outputs;
+}
+
+void QuantizedModel::processBatch(float const * inputs, unsigned numberOfSamples, float * outputs)
+{
+	if (!_quantized)
+	{
+		ERROR_MSG("The model is not quantized");
+		return;
+	}
+
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+
+	for (unsigned first=0 ; first<numberOfSamples ; first+=blockSize)
+	{
+		const unsigned n = std::min(blockSize, numberOfSamples - first);
+
+		//The values are sample-major like the inputs, the block is copied into the input layer since skip connections may read it
+		std::copy(inputs + static_cast<std::size_t>(first) * numberOfInputs, inputs + static_cast<std::size_t>(first + n) * numberOfInputs, _values.front().begin());
+
+		for (unsigned l=1 ; l<_layers.size() ; l++)
+			computeLayer(l, _values[l-1].data(), n);
+
+		std::copy(_values.back().begin(), _values.back().begin() + n * numberOfOutputs, outputs + static_cast<std::size_t>(first) * numberOfOutputs);
+	}
+}
+
+void QuantizedModel::computeLayer(unsigned l, float const * inputs, unsigned numberOfSamples)
+{
+	QuantizedLayer const & layer = _layers[l];
+	float * outputs = _values[l].data();
+	const unsigned n = numberOfSamples;
+
+	//The net values are first computed into the outputs, each row of the matrix is used for the whole block of samples
+	if (_precision == Precision::Int8)
+	{
+		const float inverseScale = 1.f / layer.inputScale;
+		_quantizedInputs.resize(static_cast<std::size_t>(n) * layer.previousSize);
+
+		for (unsigned k=0 ; k<n*layer.previousSize ; k++)
+		{
+			const float value = std::min(std::max(inputs[k] * inverseScale, -maximumQuantizedValue), maximumQuantizedValue);
+			_quantizedInputs[k] = static_cast<int8_t>(value >= 0.f ? value + 0.5f : value - 0.5f);
+		}
+
+		for (unsigned i=0 ; i<layer.size ; i++)
+		{
+			int8_t const * row = &layer.weights[static_cast<std::size_t>(i) * layer.previousSize];
+
+			for (unsigned s=0 ; s<n ; s++)
+				outputs[s * layer.size + i] = layer.scale * Simd::dot(row, &_quantizedInputs[static_cast<std::size_t>(s) * layer.previousSize], layer.previousSize);
+		}
+	}
+	else
+	{
+		_row.resize(layer.previousSize);
+
+		for (unsigned i=0 ; i<layer.size ; i++)
+		{
+			Simd::fromHalf(&layer.halfWeights[static_cast<std::size_t>(i) * layer.previousSize], _row.data(), layer.previousSize);
+
+			for (unsigned s=0 ; s<n ; s++)
+				outputs[s * layer.size + i] = Simd::dot(_row.data(), &inputs[static_cast<std::size_t>(s) * layer.previousSize], layer.previousSize);
+		}
+	}
+
+	for (QuantizedSkipConnection const & c : layer.skipConnections)
+	{
+		float const * sourceValues = _values[c.sourceLayer].data();
+
+		for (unsigned s=0 ; s<n ; s++)
+			outputs[s * layer.size + c.destinationIndex] += c.weight * sourceValues[s * _layers[c.sourceLayer].size + c.sourceIndex];
+	}
+
+	for (unsigned s=0 ; s<n ; s++)
+	{
+		float * sampleOutputs = &outputs[s * layer.size];
+
+		if (layer.activation == Activation::Softmax)
+		{
+			Activations::softmax(sampleOutputs, sampleOutputs, layer.numberOfInputs.data(), layer.size, 1);
+			continue;
+		}
+
+		//Neurons without inputs keep their value, the activation function is applied to the runs of neurons between them
+		for (unsigned first=0 ; first<layer.size ; )
+		{
+			if (layer.numberOfInputs[first] == 0)
+			{
+				sampleOutputs[first] = layer.biasValues[first];
+				first++;
+				continue;
+			}
+
+			unsigned last = first + 1;
+			while (last < layer.size && layer.numberOfInputs[last] != 0)
+				last++;
+
+			Activations::activate(layer.activation, &sampleOutputs[first], &sampleOutputs[first], last - first, _fastActivation);
+			first = last;
+		}
+	}
+}
+
+QuantizationReport QuantizedModel::compare(NeuralNetwork & network, LearningSet const & set)
+{
+	QuantizationReport report;
+
+	if (!_quantized || network.getNumberOfLayers() != _layers.size())
+	{
+		ERROR_MSG("The model is not quantized or was not made from this network");
+		return report;
+	}
+
+	const unsigned numberOfInputs = _layers.front().size;
+	const unsigned numberOfOutputs = _layers.back().size;
+	std::vector<float> inputs;
+
+	inputs.reserve(set.size() * numberOfInputs);
+
+	for (LearningPoint const & point : set)
+	{
+		if (point.first.size() != numberOfInputs || point.second.size() != numberOfOutputs)
+		{
+			ERROR_MSG("Learning vectors of sizes " << point.first.size() << " and " << point.second.size() << " do not match the number of input or output neurons");
+			return report;
+		}
+
+		inputs.insert(inputs.end(), point.first.begin(), point.first.end());
+	}
+
+	std::vector<float> floatOutputs(set.size() * numberOfOutputs);
+	std::vector<float> quantizedOutputs(set.size() * numberOfOutputs);
+	network.processBatch(inputs.data(), set.size(), floatOutputs.data());
+	processBatch(inputs.data(), set.size(), quantizedOutputs.data());
+
+	double sumOfDifferences = 0.;
+
+	for (unsigned p=0 ; p<set.size() ; p++)
+	{
+		for (unsigned i=0 ; i<numberOfOutputs ; i++)
+		{
+			const float desiredOutput = set[p].second[i];
+			const float floatOutput = floatOutputs[p * numberOfOutputs + i];
+			const float quantizedOutput = quantizedOutputs[p * numberOfOutputs + i];
+			const float difference = std::fabs(floatOutput - quantizedOutput);
+
+			report.maximumDifference = std::max(report.maximumDifference, difference);
+			sumOfDifferences += difference;
+			report.floatError += Activations::getError(_loss, _layers.back().activation, desiredOutput, floatOutput);
+			report.quantizedError += Activations::getError(_loss, _layers.back().activation, desiredOutput, quantizedOutput);
+		}
+	}
+
+	report.numberOfPoints = set.size();
+	report.meanDifference = set.empty() ? 0.f : sumOfDifferences / (set.size() * numberOfOutputs);
+
+	return report;
+}
+
+std::string QuantizedModel::toString(Precision precision)
+{
+	switch (precision)
+	{
+		case Precision::Float16:
+			return "fp16";
+		default:
+			return "int8";
+	}
+}
@@ -0,0 +1,967 @@
+#include "simd.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ENN_X86
+#include <immintrin.h>
+#endif
+
+using namespace ENN;
+
+namespace
+{
+	//Scalar kernels, they define the reference results
+
+	float dotScalar(float const * a, float const * b, unsigned n)
+	{
+		float sum = 0.f;
+
+		for (unsigned i=0 ; i<n ; i++)
+			sum += a[i] * b[i];
+
+		return sum;
+	}
+
+	void axpyScalar(float alpha, float const * x, float * y, unsigned n)
+	{
+		for (unsigned i=0 ; i<n ; i++)
+			y[i] += alpha * x[i];
+	}
+
+	void subtractProductScalar(float * y, float const * a, float const * b, unsigned n)
+	{
+		for (unsigned i=0 ; i<n ; i++)
+			y[i] -= a[i] * b[i];
+	}
+
+	void subtractScaledProductScalar(float * y, float const * a, float alpha, float const * b, unsigned n)
+	{
+		for (unsigned i=0 ; i<n ; i++)
+			y[i] -= a[i] * (alpha * b[i]);
+	}
+
+	//Optimizer kernels: one pass over the weights updates the state, applies the step and clears the gradients
+
+	void momentumScalar(float * w, float const * r, float * g, float * v, float momentum, float gradientFactor, float velocityFactor, float scale, unsigned n)
+	{
+		for (unsigned i=0 ; i<n ; i++)
+		{
+			v[i] = momentum * v[i] + g[i];
+			w[i] -= r[i] * (scale * (gradientFactor * g[i] + velocityFactor * v[i]));
+			g[i] = 0.f;
+		}
+	}
+
+	void rmsPropScalar(float * w, float const * r, float * g, float * s, float decay, float epsilon, float scale, unsigned n)
+	{
+		const float c = 1.f - decay;
+
+		for (unsigned i=0 ; i<n ; i++)
+		{
+			s[i] = decay * s[i] + c * (g[i] * g[i]);
+			w[i] -= r[i] * (scale * g[i] / (std::sqrt(s[i]) + epsilon));
+			g[i] = 0.f;
+		}
+	}
+
+	void adamScalar(float * w, float const * r, float * g, float * m, float * s, float beta1, float beta2, float epsilon, float scale, unsigned n)
+	{
+		const float c1 = 1.f - beta1;
+		const float c2 = 1.f - beta2;
+
+		for (unsigned i=0 ; i<n ; i++)
+		{
+			m[i] = beta1 * m[i] + c1 * g[i];
+			s[i] = beta2 * s[i] + c2 * (g[i] * g[i]);
+			w[i] -= r[i] * (scale * m[i] / (std::sqrt(s[i]) + epsilon));
+			g[i] = 0.f;
+		}
+	}
+
+	/* tanh(x) is approximated by x * P(x^2) / Q(x^2) on [-Clamp, Clamp] (rational fit of degree 13/6) and by x itself near 0,
+	 * the max absolute error compared to std::tanh is below 5e-7 whatever the instruction set (see benchmark 02)
+	 */
+	const float TanhClamp = 7.90531110763549805f;
+	const float TanhSmall = 0.0004f;
+	const float TanhP[7] = {-2.76076847742355e-16f, 2.00018790482477e-13f, -8.60467152213735e-11f, 5.12229709037114e-08f, 1.48572235717979e-05f, 6.37261928875436e-04f, 4.89352455891786e-03f};
+	const float TanhQ[4] = {1.19825839466702e-06f, 1.18534705686654e-04f, 2.26843463243900e-03f, 4.89352518554385e-03f};
+
+	float fastTanh(float x)
+	{
+		if (std::fabs(x) < TanhSmall)
+			return x;
+
+		x = std::min(std::max(x, -TanhClamp), TanhClamp);
+		const float x2 = x * x;
+
+		float p = TanhP[0];
+		for (unsigned k=1 ; k<7 ; k++)
+			p = p * x2 + TanhP[k];
+
+		float q = TanhQ[0];
+		for (unsigned k=1 ; k<4 ; k++)
+			q = q * x2 + TanhQ[k];
+
+		return x * p / q;
+	}
+
+	void tanhScalar(float const * x, float * y, unsigned n)
+	{
+		for (unsigned i=0 ; i<n ; i++)
+			y[i] = fastTanh(x[i]);
+	}
+
+	//The integer kernels are exact, so every instruction set gives the same results
+
+	int32_t dotInt8Scalar(int8_t const * a, int8_t const * b, unsigned n)
+	{
+		int32_t sum = 0;
+
+		for (unsigned i=0 ; i<n ; i++)
+			sum += a[i] * b[i];
+
+		return sum;
+	}
+
+	float halfToFloat(uint16_t half)
+	{
+		const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+		int32_t exponent = (half >> 10) & 0x1f;
+		uint32_t mantissa = half & 0x3ffu;
+		uint32_t bits = sign;
+
+		if (exponent == 0x1f) //Infinity or NaN
+		{
+			bits |= 0x7f800000u | (mantissa << 13);
+		}
+		else if (exponent != 0 || mantissa != 0)
+		{
+			//Subnormal halves are normal floats: shift the mantissa until its implicit bit appears
+			if (exponent == 0)
+			{
+				exponent = 1;
+
+				while ((mantissa & 0x400u) == 0)
+				{
+					mantissa <<= 1;
+					exponent--;
+				}
+
+				mantissa &= 0x3ffu;
+			}
+
+			bits |= (static_cast<uint32_t>(exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	void fromHalfScalar(uint16_t const * x, float * y, unsigned n)
+	{
+		for (unsigned i=0 ; i<n ; i++)
+			y[i] = halfToFloat(x[i]);
+	}
+
+#ifdef ENN_X86
+
+	//SSE kernels (4 floats)
+
+	float dotSSE(float const * a, float const * b, unsigned n)
+	{
+		__m128 sum0 = _mm_setzero_ps();
+		__m128 sum1 = _mm_setzero_ps();
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+		{
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+		}
+
+		__m128 sum = _mm_add_ps(sum0, sum1);
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		float result = _mm_cvtss_f32(sum);
+
+		for ( ; i<n ; i++)
+			result += a[i] * b[i];
+
+		return result;
+	}
+
+	void axpySSE(float alpha, float const * x, float * y, unsigned n)
+	{
+		const __m128 a = _mm_set1_ps(alpha);
+		unsigned i = 0;
+
+		for ( ; i+4<=n ; i+=4)
+			_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(a, _mm_loadu_ps(x + i))));
+
+		axpyScalar(alpha, x + i, y + i, n - i);
+	}
+
+	void subtractProductSSE(float * y, float const * a, float const * b, unsigned n)
+	{
+		unsigned i = 0;
+
+		for ( ; i+4<=n ; i+=4)
+			_mm_storeu_ps(y + i, _mm_sub_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))));
+
+		subtractProductScalar(y + i, a + i, b + i, n - i);
+	}
+
+	void subtractScaledProductSSE(float * y, float const * a, float alpha, float const * b, unsigned n)
+	{
+		const __m128 s = _mm_set1_ps(alpha);
+		unsigned i = 0;
+
+		for ( ; i+4<=n ; i+=4)
+			_mm_storeu_ps(y + i, _mm_sub_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(a + i), _mm_mul_ps(s, _mm_loadu_ps(b + i)))));
+
+		subtractScaledProductScalar(y + i, a + i, alpha, b + i, n - i);
+	}
+
+	void momentumSSE(float * w, float const * r, float * g, float * v, float momentum, float gradientFactor, float velocityFactor, float scale, unsigned n)
+	{
+		const __m128 mu = _mm_set1_ps(momentum), a = _mm_set1_ps(gradientFactor), b = _mm_set1_ps(velocityFactor), k = _mm_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+4<=n ; i+=4)
+		{
+			const __m128 gi = _mm_loadu_ps(g + i);
+			const __m128 vi = _mm_add_ps(_mm_mul_ps(mu, _mm_loadu_ps(v + i)), gi);
+			const __m128 step = _mm_mul_ps(k, _mm_add_ps(_mm_mul_ps(a, gi), _mm_mul_ps(b, vi)));
+			_mm_storeu_ps(v + i, vi);
+			_mm_storeu_ps(w + i, _mm_sub_ps(_mm_loadu_ps(w + i), _mm_mul_ps(_mm_loadu_ps(r + i), step)));
+			_mm_storeu_ps(g + i, _mm_setzero_ps());
+		}
+
+		momentumScalar(w + i, r + i, g + i, v + i, momentum, gradientFactor, velocityFactor, scale, n - i);
+	}
+
+	void rmsPropSSE(float * w, float const * r, float * g, float * s, float decay, float epsilon, float scale, unsigned n)
+	{
+		const __m128 d = _mm_set1_ps(decay), c = _mm_set1_ps(1.f - decay), e = _mm_set1_ps(epsilon), k = _mm_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+4<=n ; i+=4)
+		{
+			const __m128 gi = _mm_loadu_ps(g + i);
+			const __m128 si = _mm_add_ps(_mm_mul_ps(d, _mm_loadu_ps(s + i)), _mm_mul_ps(c, _mm_mul_ps(gi, gi)));
+			const __m128 step = _mm_div_ps(_mm_mul_ps(k, gi), _mm_add_ps(_mm_sqrt_ps(si), e));
+			_mm_storeu_ps(s + i, si);
+			_mm_storeu_ps(w + i, _mm_sub_ps(_mm_loadu_ps(w + i), _mm_mul_ps(_mm_loadu_ps(r + i), step)));
+			_mm_storeu_ps(g + i, _mm_setzero_ps());
+		}
+
+		rmsPropScalar(w + i, r + i, g + i, s + i, decay, epsilon, scale, n - i);
+	}
+
+	void adamSSE(float * w, float const * r, float * g, float * m, float * s, float beta1, float beta2, float epsilon, float scale, unsigned n)
+	{
+		const __m128 b1 = _mm_set1_ps(beta1), c1 = _mm_set1_ps(1.f - beta1), b2 = _mm_set1_ps(beta2), c2 = _mm_set1_ps(1.f - beta2);
+		const __m128 e = _mm_set1_ps(epsilon), k = _mm_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+4<=n ; i+=4)
+		{
+			const __m128 gi = _mm_loadu_ps(g + i);
+			const __m128 mi = _mm_add_ps(_mm_mul_ps(b1, _mm_loadu_ps(m + i)), _mm_mul_ps(c1, gi));
+			const __m128 si = _mm_add_ps(_mm_mul_ps(b2, _mm_loadu_ps(s + i)), _mm_mul_ps(c2, _mm_mul_ps(gi, gi)));
+			const __m128 step = _mm_div_ps(_mm_mul_ps(k, mi), _mm_add_ps(_mm_sqrt_ps(si), e));
+			_mm_storeu_ps(m + i, mi);
+			_mm_storeu_ps(s + i, si);
+			_mm_storeu_ps(w + i, _mm_sub_ps(_mm_loadu_ps(w + i), _mm_mul_ps(_mm_loadu_ps(r + i), step)));
+			_mm_storeu_ps(g + i, _mm_setzero_ps());
+		}
+
+		adamScalar(w + i, r + i, g + i, m + i, s + i, beta1, beta2, epsilon, scale, n - i);
+	}
+
+	void tanhSSE(float const * x, float * y, unsigned n)
+	{
+		const __m128 clamp = _mm_set1_ps(TanhClamp);
+		const __m128 small = _mm_set1_ps(TanhSmall);
+		const __m128 signMask = _mm_set1_ps(-0.f);
+		unsigned i = 0;
+
+		for ( ; i+4<=n ; i+=4)
+		{
+			const __m128 input = _mm_loadu_ps(x + i);
+			const __m128 v = _mm_min_ps(_mm_max_ps(input, _mm_sub_ps(_mm_setzero_ps(), clamp)), clamp);
+			const __m128 v2 = _mm_mul_ps(v, v);
+
+			__m128 p = _mm_set1_ps(TanhP[0]);
+			for (unsigned k=1 ; k<7 ; k++)
+				p = _mm_add_ps(_mm_mul_ps(p, v2), _mm_set1_ps(TanhP[k]));
+
+			__m128 q = _mm_set1_ps(TanhQ[0]);
+			for (unsigned k=1 ; k<4 ; k++)
+				q = _mm_add_ps(_mm_mul_ps(q, v2), _mm_set1_ps(TanhQ[k]));
+
+			const __m128 result = _mm_div_ps(_mm_mul_ps(v, p), q);
+			const __m128 isSmall = _mm_cmplt_ps(_mm_andnot_ps(signMask, input), small);
+			_mm_storeu_ps(y + i, _mm_or_ps(_mm_and_ps(isSmall, input), _mm_andnot_ps(isSmall, result)));
+		}
+
+		tanhScalar(x + i, y + i, n - i);
+	}
+
+	int32_t dotInt8SSE(int8_t const * a, int8_t const * b, unsigned n)
+	{
+		//SSE2 has no sign extension of bytes: each byte is duplicated into a 16-bit word, then shifted back with its sign
+		__m128i sum = _mm_setzero_si128();
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+		{
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i));
+			const __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + i));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8), _mm_srai_epi16(_mm_unpacklo_epi8(y, y), 8)));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8), _mm_srai_epi16(_mm_unpackhi_epi8(y, y), 8)));
+		}
+
+		alignas(16) int32_t partialSums[4];
+		_mm_store_si128(reinterpret_cast<__m128i *>(partialSums), sum);
+
+		return partialSums[0] + partialSums[1] + partialSums[2] + partialSums[3] + dotInt8Scalar(a + i, b + i, n - i);
+	}
+
+	//AVX2 kernels (8 floats), the element-wise kernels do not use FMA so that they round like the scalar ones
+
+	__attribute__((target("avx2,fma")))
+	float dotAVX2(float const * a, float const * b, unsigned n)
+	{
+		__m256 sum0 = _mm256_setzero_ps();
+		__m256 sum1 = _mm256_setzero_ps();
+		__m256 sum2 = _mm256_setzero_ps();
+		__m256 sum3 = _mm256_setzero_ps();
+		unsigned i = 0;
+
+		for ( ; i+32<=n ; i+=32)
+		{
+			sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+			sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+			sum2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), sum2);
+			sum3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), sum3);
+		}
+
+		for ( ; i+8<=n ; i+=8)
+			sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+
+		const __m256 sum = _mm256_add_ps(_mm256_add_ps(sum0, sum1), _mm256_add_ps(sum2, sum3));
+		__m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+		half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+		half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+		float result = _mm_cvtss_f32(half);
+
+		for ( ; i<n ; i++)
+			result += a[i] * b[i];
+
+		return result;
+	}
+
+	__attribute__((target("avx2")))
+	void axpyAVX2(float alpha, float const * x, float * y, unsigned n)
+	{
+		const __m256 a = _mm256_set1_ps(alpha);
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+			_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(a, _mm256_loadu_ps(x + i))));
+
+		axpyScalar(alpha, x + i, y + i, n - i);
+	}
+
+	__attribute__((target("avx2")))
+	void subtractProductAVX2(float * y, float const * a, float const * b, unsigned n)
+	{
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+			_mm256_storeu_ps(y + i, _mm256_sub_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))));
+
+		subtractProductScalar(y + i, a + i, b + i, n - i);
+	}
+
+	__attribute__((target("avx2")))
+	void subtractScaledProductAVX2(float * y, float const * a, float alpha, float const * b, unsigned n)
+	{
+		const __m256 s = _mm256_set1_ps(alpha);
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+			_mm256_storeu_ps(y + i, _mm256_sub_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_mul_ps(s, _mm256_loadu_ps(b + i)))));
+
+		subtractScaledProductScalar(y + i, a + i, alpha, b + i, n - i);
+	}
+
+	__attribute__((target("avx2")))
+	void momentumAVX2(float * w, float const * r, float * g, float * v, float momentum, float gradientFactor, float velocityFactor, float scale, unsigned n)
+	{
+		const __m256 mu = _mm256_set1_ps(momentum), a = _mm256_set1_ps(gradientFactor), b = _mm256_set1_ps(velocityFactor), k = _mm256_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+		{
+			const __m256 gi = _mm256_loadu_ps(g + i);
+			const __m256 vi = _mm256_add_ps(_mm256_mul_ps(mu, _mm256_loadu_ps(v + i)), gi);
+			const __m256 step = _mm256_mul_ps(k, _mm256_add_ps(_mm256_mul_ps(a, gi), _mm256_mul_ps(b, vi)));
+			_mm256_storeu_ps(v + i, vi);
+			_mm256_storeu_ps(w + i, _mm256_sub_ps(_mm256_loadu_ps(w + i), _mm256_mul_ps(_mm256_loadu_ps(r + i), step)));
+			_mm256_storeu_ps(g + i, _mm256_setzero_ps());
+		}
+
+		momentumScalar(w + i, r + i, g + i, v + i, momentum, gradientFactor, velocityFactor, scale, n - i);
+	}
+
+	__attribute__((target("avx2")))
+	void rmsPropAVX2(float * w, float const * r, float * g, float * s, float decay, float epsilon, float scale, unsigned n)
+	{
+		const __m256 d = _mm256_set1_ps(decay), c = _mm256_set1_ps(1.f - decay), e = _mm256_set1_ps(epsilon), k = _mm256_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+		{
+			const __m256 gi = _mm256_loadu_ps(g + i);
+			const __m256 si = _mm256_add_ps(_mm256_mul_ps(d, _mm256_loadu_ps(s + i)), _mm256_mul_ps(c, _mm256_mul_ps(gi, gi)));
+			const __m256 step = _mm256_div_ps(_mm256_mul_ps(k, gi), _mm256_add_ps(_mm256_sqrt_ps(si), e));
+			_mm256_storeu_ps(s + i, si);
+			_mm256_storeu_ps(w + i, _mm256_sub_ps(_mm256_loadu_ps(w + i), _mm256_mul_ps(_mm256_loadu_ps(r + i), step)));
+			_mm256_storeu_ps(g + i, _mm256_setzero_ps());
+		}
+
+		rmsPropScalar(w + i, r + i, g + i, s + i, decay, epsilon, scale, n - i);
+	}
+
+	__attribute__((target("avx2")))
+	void adamAVX2(float * w, float const * r, float * g, float * m, float * s, float beta1, float beta2, float epsilon, float scale, unsigned n)
+	{
+		const __m256 b1 = _mm256_set1_ps(beta1), c1 = _mm256_set1_ps(1.f - beta1), b2 = _mm256_set1_ps(beta2), c2 = _mm256_set1_ps(1.f - beta2);
+		const __m256 e = _mm256_set1_ps(epsilon), k = _mm256_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+		{
+			const __m256 gi = _mm256_loadu_ps(g + i);
+			const __m256 mi = _mm256_add_ps(_mm256_mul_ps(b1, _mm256_loadu_ps(m + i)), _mm256_mul_ps(c1, gi));
+			const __m256 si = _mm256_add_ps(_mm256_mul_ps(b2, _mm256_loadu_ps(s + i)), _mm256_mul_ps(c2, _mm256_mul_ps(gi, gi)));
+			const __m256 step = _mm256_div_ps(_mm256_mul_ps(k, mi), _mm256_add_ps(_mm256_sqrt_ps(si), e));
+			_mm256_storeu_ps(m + i, mi);
+			_mm256_storeu_ps(s + i, si);
+			_mm256_storeu_ps(w + i, _mm256_sub_ps(_mm256_loadu_ps(w + i), _mm256_mul_ps(_mm256_loadu_ps(r + i), step)));
+			_mm256_storeu_ps(g + i, _mm256_setzero_ps());
+		}
+
+		adamScalar(w + i, r + i, g + i, m + i, s + i, beta1, beta2, epsilon, scale, n - i);
+	}
+
+	__attribute__((target("avx2,fma")))
+	void tanhAVX2(float const * x, float * y, unsigned n)
+	{
+		const __m256 clamp = _mm256_set1_ps(TanhClamp);
+		const __m256 small = _mm256_set1_ps(TanhSmall);
+		const __m256 signMask = _mm256_set1_ps(-0.f);
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+		{
+			const __m256 input = _mm256_loadu_ps(x + i);
+			const __m256 v = _mm256_min_ps(_mm256_max_ps(input, _mm256_sub_ps(_mm256_setzero_ps(), clamp)), clamp);
+			const __m256 v2 = _mm256_mul_ps(v, v);
+
+			__m256 p = _mm256_set1_ps(TanhP[0]);
+			for (unsigned k=1 ; k<7 ; k++)
+				p = _mm256_fmadd_ps(p, v2, _mm256_set1_ps(TanhP[k]));
+
+			__m256 q = _mm256_set1_ps(TanhQ[0]);
+			for (unsigned k=1 ; k<4 ; k++)
+				q = _mm256_fmadd_ps(q, v2, _mm256_set1_ps(TanhQ[k]));
+
+			const __m256 result = _mm256_div_ps(_mm256_mul_ps(v, p), q);
+			const __m256 isSmall = _mm256_cmp_ps(_mm256_andnot_ps(signMask, input), small, _CMP_LT_OQ);
+			_mm256_storeu_ps(y + i, _mm256_blendv_ps(result, input, isSmall));
+		}
+
+		tanhScalar(x + i, y + i, n - i);
+	}
+
+	__attribute__((target("avx2")))
+	int32_t dotInt8AVX2(int8_t const * a, int8_t const * b, unsigned n)
+	{
+		//The bytes are sign extended to 16-bit words, whose products are summed by pairs into 32-bit integers
+		__m256i sum = _mm256_setzero_si256();
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+		{
+			const __m256i x = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i)));
+			const __m256i y = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const *>(b + i)));
+			sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, y));
+		}
+
+		__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		return _mm_cvtsi128_si32(half) + dotInt8Scalar(a + i, b + i, n - i);
+	}
+
+	__attribute__((target("avx2,f16c")))
+	void fromHalfAVX2(uint16_t const * x, float * y, unsigned n)
+	{
+		unsigned i = 0;
+
+		for ( ; i+8<=n ; i+=8)
+			_mm256_storeu_ps(y + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const *>(x + i))));
+
+		fromHalfScalar(x + i, y + i, n - i);
+	}
+
+	//AVX-512 kernels (16 floats), the tails are handled with masks
+
+	__attribute__((target("avx512f")))
+	float dotAVX512(float const * a, float const * b, unsigned n)
+	{
+		__m512 sum0 = _mm512_setzero_ps();
+		__m512 sum1 = _mm512_setzero_ps();
+		__m512 sum2 = _mm512_setzero_ps();
+		__m512 sum3 = _mm512_setzero_ps();
+		unsigned i = 0;
+
+		for ( ; i+64<=n ; i+=64)
+		{
+			sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+			sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+			sum2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32), sum2);
+			sum3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48), sum3);
+		}
+
+		for ( ; i+16<=n ; i+=16)
+			sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+
+		if (i < n)
+		{
+			const __mmask16 mask = (1u << (n - i)) - 1;
+			sum1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), sum1);
+		}
+
+		//Fold the 16 partial sums down to 4, then finish like SSE
+		alignas(64) float partialSums[16];
+		_mm512_store_ps(partialSums, _mm512_add_ps(_mm512_add_ps(sum0, sum1), _mm512_add_ps(sum2, sum3)));
+		__m128 quarter = _mm_add_ps(_mm_add_ps(_mm_load_ps(partialSums), _mm_load_ps(partialSums + 4)), _mm_add_ps(_mm_load_ps(partialSums + 8), _mm_load_ps(partialSums + 12)));
+		quarter = _mm_add_ps(quarter, _mm_movehl_ps(quarter, quarter));
+		quarter = _mm_add_ss(quarter, _mm_shuffle_ps(quarter, quarter, 1));
+
+		return _mm_cvtss_f32(quarter);
+	}
+
+	__attribute__((target("avx512f")))
+	void axpyAVX512(float alpha, float const * x, float * y, unsigned n)
+	{
+		const __m512 a = _mm512_set1_ps(alpha);
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+			_mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(a, _mm512_loadu_ps(x + i))));
+
+		if (i < n)
+		{
+			const __mmask16 mask = (1u << (n - i)) - 1;
+			_mm512_mask_storeu_ps(y + i, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, y + i), _mm512_mul_ps(a, _mm512_maskz_loadu_ps(mask, x + i))));
+		}
+	}
+
+	__attribute__((target("avx512f")))
+	void subtractProductAVX512(float * y, float const * a, float const * b, unsigned n)
+	{
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+			_mm512_storeu_ps(y + i, _mm512_sub_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i))));
+
+		if (i < n)
+		{
+			const __mmask16 mask = (1u << (n - i)) - 1;
+			_mm512_mask_storeu_ps(y + i, mask, _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, y + i), _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i))));
+		}
+	}
+
+	__attribute__((target("avx512f")))
+	void subtractScaledProductAVX512(float * y, float const * a, float alpha, float const * b, unsigned n)
+	{
+		const __m512 s = _mm512_set1_ps(alpha);
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+			_mm512_storeu_ps(y + i, _mm512_sub_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_mul_ps(s, _mm512_loadu_ps(b + i)))));
+
+		if (i < n)
+		{
+			const __mmask16 mask = (1u << (n - i)) - 1;
+			_mm512_mask_storeu_ps(y + i, mask, _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, y + i), _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_mul_ps(s, _mm512_maskz_loadu_ps(mask, b + i)))));
+		}
+	}
+
+	//GCC 12 wrongly warns about the undefined pass-through operand of _mm512_sqrt_ps, _mm512_min_ps and _mm512_max_ps
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+	//The tails of the optimizer kernels go through the scalar kernels, with the same arithmetic
+
+	__attribute__((target("avx512f")))
+	void momentumAVX512(float * w, float const * r, float * g, float * v, float momentum, float gradientFactor, float velocityFactor, float scale, unsigned n)
+	{
+		const __m512 mu = _mm512_set1_ps(momentum), a = _mm512_set1_ps(gradientFactor), b = _mm512_set1_ps(velocityFactor), k = _mm512_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+		{
+			const __m512 gi = _mm512_loadu_ps(g + i);
+			const __m512 vi = _mm512_add_ps(_mm512_mul_ps(mu, _mm512_loadu_ps(v + i)), gi);
+			const __m512 step = _mm512_mul_ps(k, _mm512_add_ps(_mm512_mul_ps(a, gi), _mm512_mul_ps(b, vi)));
+			_mm512_storeu_ps(v + i, vi);
+			_mm512_storeu_ps(w + i, _mm512_sub_ps(_mm512_loadu_ps(w + i), _mm512_mul_ps(_mm512_loadu_ps(r + i), step)));
+			_mm512_storeu_ps(g + i, _mm512_setzero_ps());
+		}
+
+		momentumScalar(w + i, r + i, g + i, v + i, momentum, gradientFactor, velocityFactor, scale, n - i);
+	}
+
+	__attribute__((target("avx512f")))
+	void rmsPropAVX512(float * w, float const * r, float * g, float * s, float decay, float epsilon, float scale, unsigned n)
+	{
+		const __m512 d = _mm512_set1_ps(decay), c = _mm512_set1_ps(1.f - decay), e = _mm512_set1_ps(epsilon), k = _mm512_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+		{
+			const __m512 gi = _mm512_loadu_ps(g + i);
+			const __m512 si = _mm512_add_ps(_mm512_mul_ps(d, _mm512_loadu_ps(s + i)), _mm512_mul_ps(c, _mm512_mul_ps(gi, gi)));
+			const __m512 step = _mm512_div_ps(_mm512_mul_ps(k, gi), _mm512_add_ps(_mm512_sqrt_ps(si), e));
+			_mm512_storeu_ps(s + i, si);
+			_mm512_storeu_ps(w + i, _mm512_sub_ps(_mm512_loadu_ps(w + i), _mm512_mul_ps(_mm512_loadu_ps(r + i), step)));
+			_mm512_storeu_ps(g + i, _mm512_setzero_ps());
+		}
+
+		rmsPropScalar(w + i, r + i, g + i, s + i, decay, epsilon, scale, n - i);
+	}
+
+	__attribute__((target("avx512f")))
+	void adamAVX512(float * w, float const * r, float * g, float * m, float * s, float beta1, float beta2, float epsilon, float scale, unsigned n)
+	{
+		const __m512 b1 = _mm512_set1_ps(beta1), c1 = _mm512_set1_ps(1.f - beta1), b2 = _mm512_set1_ps(beta2), c2 = _mm512_set1_ps(1.f - beta2);
+		const __m512 e = _mm512_set1_ps(epsilon), k = _mm512_set1_ps(scale);
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+		{
+			const __m512 gi = _mm512_loadu_ps(g + i);
+			const __m512 mi = _mm512_add_ps(_mm512_mul_ps(b1, _mm512_loadu_ps(m + i)), _mm512_mul_ps(c1, gi));
+			const __m512 si = _mm512_add_ps(_mm512_mul_ps(b2, _mm512_loadu_ps(s + i)), _mm512_mul_ps(c2, _mm512_mul_ps(gi, gi)));
+			const __m512 step = _mm512_div_ps(_mm512_mul_ps(k, mi), _mm512_add_ps(_mm512_sqrt_ps(si), e));
+			_mm512_storeu_ps(m + i, mi);
+			_mm512_storeu_ps(s + i, si);
+			_mm512_storeu_ps(w + i, _mm512_sub_ps(_mm512_loadu_ps(w + i), _mm512_mul_ps(_mm512_loadu_ps(r + i), step)));
+			_mm512_storeu_ps(g + i, _mm512_setzero_ps());
+		}
+
+		adamScalar(w + i, r + i, g + i, m + i, s + i, beta1, beta2, epsilon, scale, n - i);
+	}
+
+
+	__attribute__((target("avx512f")))
+	__m512 tanhAVX512(__m512 input)
+	{
+		const __m512 clamp = _mm512_set1_ps(TanhClamp);
+		const __m512 v = _mm512_min_ps(_mm512_max_ps(input, _mm512_sub_ps(_mm512_setzero_ps(), clamp)), clamp);
+		const __m512 v2 = _mm512_mul_ps(v, v);
+
+		__m512 p = _mm512_set1_ps(TanhP[0]);
+		for (unsigned k=1 ; k<7 ; k++)
+			p = _mm512_fmadd_ps(p, v2, _mm512_set1_ps(TanhP[k]));
+
+		__m512 q = _mm512_set1_ps(TanhQ[0]);
+		for (unsigned k=1 ; k<4 ; k++)
+			q = _mm512_fmadd_ps(q, v2, _mm512_set1_ps(TanhQ[k]));
+
+		const __m512 result = _mm512_div_ps(_mm512_mul_ps(v, p), q);
+		const __mmask16 isSmall = _mm512_cmp_ps_mask(_mm512_abs_ps(input), _mm512_set1_ps(TanhSmall), _CMP_LT_OQ);
+
+		return _mm512_mask_blend_ps(isSmall, result, input);
+	}
+
+	__attribute__((target("avx512f")))
+	void tanhAVX512(float const * x, float * y, unsigned n)
+	{
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+			_mm512_storeu_ps(y + i, tanhAVX512(_mm512_loadu_ps(x + i)));
+
+		if (i < n)
+		{
+			const __mmask16 mask = (1u << (n - i)) - 1;
+			_mm512_mask_storeu_ps(y + i, mask, tanhAVX512(_mm512_maskz_loadu_ps(mask, x + i)));
+		}
+	}
+
+	__attribute__((target("avx512f,avx512bw,avx512vnni")))
+	int32_t dotInt8VNNI(int8_t const * a, int8_t const * b, unsigned n)
+	{
+		/* vpdpbusd multiplies unsigned bytes by signed bytes and adds each group of 4 products to a 32-bit integer in one instruction.
+		 * a is made unsigned with its absolute value and its sign moves to b (the quantized values are in [-127, 127], so both are exact).
+		 */
+		const __m512i zero = _mm512_setzero_si512();
+		__m512i sum0 = _mm512_setzero_si512();
+		__m512i sum1 = _mm512_setzero_si512();
+		unsigned i = 0;
+
+		for ( ; i+128<=n ; i+=128)
+		{
+			const __m512i x0 = _mm512_loadu_si512(a + i);
+			const __m512i y0 = _mm512_loadu_si512(b + i);
+			const __m512i x1 = _mm512_loadu_si512(a + i + 64);
+			const __m512i y1 = _mm512_loadu_si512(b + i + 64);
+			sum0 = _mm512_dpbusd_epi32(sum0, _mm512_abs_epi8(x0), _mm512_mask_sub_epi8(y0, _mm512_movepi8_mask(x0), zero, y0));
+			sum1 = _mm512_dpbusd_epi32(sum1, _mm512_abs_epi8(x1), _mm512_mask_sub_epi8(y1, _mm512_movepi8_mask(x1), zero, y1));
+		}
+
+		for ( ; i<n ; i+=64)
+		{
+			const __mmask64 mask = n - i >= 64 ? ~0ull : (1ull << (n - i)) - 1;
+			const __m512i x = _mm512_maskz_loadu_epi8(mask, a + i);
+			const __m512i y = _mm512_maskz_loadu_epi8(mask, b + i);
+			sum0 = _mm512_dpbusd_epi32(sum0, _mm512_abs_epi8(x), _mm512_mask_sub_epi8(y, _mm512_movepi8_mask(x), zero, y));
+		}
+
+		alignas(64) int32_t partialSums[16];
+		_mm512_store_si512(partialSums, _mm512_add_epi32(sum0, sum1));
+		int32_t result = 0;
+
+		for (int32_t partialSum : partialSums)
+			result += partialSum;
+
+		return result;
+	}
+
+	__attribute__((target("avx512f")))
+	void fromHalfAVX512(uint16_t const * x, float * y, unsigned n)
+	{
+		unsigned i = 0;
+
+		for ( ; i+16<=n ; i+=16)
+			_mm512_storeu_ps(y + i, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(x + i))));
+
+		fromHalfScalar(x + i, y + i, n - i);
+	}
+
+	#pragma GCC diagnostic pop
+
+#endif //ENN_X86
+
+	struct Kernels
+	{
+		Simd::InstructionSet instructionSet;
+		float (*dot)(float const *, float const *, unsigned);
+		void (*axpy)(float, float const *, float *, unsigned);
+		void (*subtractProduct)(float *, float const *, float const *, unsigned);
+		void (*subtractScaledProduct)(float *, float const *, float, float const *, unsigned);
+		void (*tanh)(float const *, float *, unsigned);
+		int32_t (*dotInt8)(int8_t const *, int8_t const *, unsigned);
+		void (*fromHalf)(uint16_t const *, float *, unsigned);
+		void (*momentum)(float *, float const *, float *, float *, float, float, float, float, unsigned);
+		void (*rmsProp)(float *, float const *, float *, float *, float, float, float, unsigned);
+		void (*adam)(float *, float const *, float *, float *, float *, float, float, float, float, unsigned);
+	};
+
+	Kernels getKernels(Simd::InstructionSet instructionSet)
+	{
+		switch (instructionSet)
+		{
+#ifdef ENN_X86
+			case Simd::InstructionSet::AVX512:
+				return {instructionSet, dotAVX512, axpyAVX512, subtractProductAVX512, subtractScaledProductAVX512, tanhAVX512,
+				        Simd::hasVNNI() ? dotInt8VNNI : dotInt8AVX2, fromHalfAVX512, momentumAVX512, rmsPropAVX512, adamAVX512};
+			case Simd::InstructionSet::AVX2:
+				return {instructionSet, dotAVX2, axpyAVX2, subtractProductAVX2, subtractScaledProductAVX2, tanhAVX2, dotInt8AVX2, fromHalfAVX2,
+				        momentumAVX2, rmsPropAVX2, adamAVX2};
+			case Simd::InstructionSet::SSE:
+				return {instructionSet, dotSSE, axpySSE, subtractProductSSE, subtractScaledProductSSE, tanhSSE, dotInt8SSE, fromHalfScalar,
+				        momentumSSE, rmsPropSSE, adamSSE};
+#endif
+			default:
+				return {Simd::InstructionSet::Scalar, dotScalar, axpyScalar, subtractProductScalar, subtractScaledProductScalar, tanhScalar, dotInt8Scalar, fromHalfScalar,
+				        momentumScalar, rmsPropScalar, adamScalar};
+		}
+	}
+
+	//Chosen once when the library is loaded
+	Kernels kernels = getKernels(Simd::getBestInstructionSet());
+}
+
+Simd::InstructionSet Simd::getBestInstructionSet()
+{
+#ifdef ENN_X86
+	__builtin_cpu_init();
+
+	const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+
+	//The AVX-512 tier falls back to some AVX2 kernels, a hypervisor may expose AVX-512F without them
+	if (avx2 && __builtin_cpu_supports("avx512f"))
+		return InstructionSet::AVX512;
+	if (avx2)
+		return InstructionSet::AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return InstructionSet::SSE;
+#endif
+
+	return InstructionSet::Scalar;
+}
+
+bool Simd::hasVNNI()
+{
+#ifdef ENN_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni");
+#else
+	return false;
+#endif
+}
+
+Simd::InstructionSet Simd::getInstructionSet()
+{
+	return kernels.instructionSet;
+}
+
+void Simd::setInstructionSet(InstructionSet instructionSet)
+{
+	if (instructionSet > getBestInstructionSet())
+	{
+		WARNING_MSG(toString(instructionSet) << " is not supported by this CPU, using " << toString(getBestInstructionSet()));
+		instructionSet = getBestInstructionSet();
+	}
+
+	kernels = getKernels(instructionSet);
+}
+
+std::string Simd::toString(InstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+		case InstructionSet::AVX512:
+			return "AVX-512";
+		case InstructionSet::AVX2:
+			return "AVX2";
+		case InstructionSet::SSE:
+			return "SSE";
+		default:
+			return "scalar";
+	}
+}
+
+float Simd::dot(float const * a, float const * b, unsigned n)
+{
+	return kernels.dot(a, b, n);
+}
+
+void Simd::axpy(float alpha, float const * x, float * y, unsigned n)
+{
+	kernels.axpy(alpha, x, y, n);
+}
+
+void Simd::subtractProduct(float * y, float const * a, float const * b, unsigned n)
+{
+	kernels.subtractProduct(y, a, b, n);
+}
+
+void Simd::subtractScaledProduct(float * y, float const * a, float alpha, float const * b, unsigned n)
+{
+	kernels.subtractScaledProduct(y, a, alpha, b, n);
+}
+
+void Simd::momentum(float * w, float const * r, float * g, float * v, float momentum, float gradientFactor, float velocityFactor, float scale, unsigned n)
+{
+	kernels.momentum(w, r, g, v, momentum, gradientFactor, velocityFactor, scale, n);
+}
+
+void Simd::rmsProp(float * w, float const * r, float * g, float * s, float decay, float epsilon, float scale, unsigned n)
+{
+	kernels.rmsProp(w, r, g, s, decay, epsilon, scale, n);
+}
+
+void Simd::adam(float * w, float const * r, float * g, float * m, float * s, float beta1, float beta2, float epsilon, float scale, unsigned n)
+{
+	kernels.adam(w, r, g, m, s, beta1, beta2, epsilon, scale, n);
+}
+
+void Simd::tanh(float const * x, float * y, unsigned n)
+{
+	kernels.tanh(x, y, n);
+}
+
+int32_t Simd::dot(int8_t const * a, int8_t const * b, unsigned n)
+{
+	return kernels.dotInt8(a, b, n);
+}
+
+void Simd::fromHalf(uint16_t const * x, float * y, unsigned n)
+{
+	kernels.fromHalf(x, y, n);
+}
+
+void Simd::toHalf(float const * x, uint16_t * y, unsigned n)
+{
+	//Round to nearest even, like the F16C instructions (only used once per weight, when a network is quantized)
+	for (unsigned i=0 ; i<n ; i++)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &x[i], sizeof(bits));
+
+		const uint16_t sign = (bits >> 16) & 0x8000u;
+		const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+		uint32_t mantissa = bits & 0x7fffffu;
+
+		if (((bits >> 23) & 0xff) == 0xff) //Infinity or NaN
+		{
+			y[i] = sign | 0x7c00u | (mantissa ? 0x200u : 0u);
+		}
+		else if (exponent >= 0x1f) //Too large, rounded to infinity
+		{
+			y[i] = sign | 0x7c00u;
+		}
+		else if (exponent <= 0) //Subnormal half (or zero)
+		{
+			if (exponent < -10)
+			{
+				y[i] = sign;
+				continue;
+			}
+
+			mantissa |= 0x800000u;
+			const unsigned shift = 14 - exponent;
+			uint32_t half = mantissa >> shift;
+			const uint32_t remainder = mantissa & ((1u << shift) - 1);
+			const uint32_t halfway = 1u << (shift - 1);
+
+			if (remainder > halfway || (remainder == halfway && (half & 1)))
+				half++;
+
+			y[i] = sign | half;
+		}
+		else
+		{
+			//A carry out of the mantissa correctly increments the exponent (up to infinity)
+			uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+			const uint32_t remainder = mantissa & 0x1fffu;
+
+			if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1)))
+				half++;
+
+			y[i] = sign | half;
+		}
+	}
+}
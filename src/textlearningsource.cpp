@@ -0,0 +1,72 @@
+#include "textlearningsource.hpp"
+
+using namespace ENN;
+
+TextLearningSource::TextLearningSource(std::string const & fileName, Parser parser, unsigned bufferSize)
+ : PrefetchedLearningSource(bufferSize), _fileName(fileName), _file(fileName), _lineNumber(0), _parser(parser)
+{
+	if (!_file.is_open())
+		ERROR_MSG("Cannot open file " << fileName);
+}
+
+TextLearningSource::~TextLearningSource()
+{
+	stop();
+}
+
+bool TextLearningSource::isOpen() const
+{
+	return _file.is_open();
+}
+
+bool TextLearningSource::parseNumbers(std::string const & line, LearningVector & inputs, LearningVector & outputs)
+{
+	const std::size_t separator = line.find(';');
+
+	if (separator == std::string::npos)
+		return false;
+
+	//The vectors keep their capacity from one line to the next
+	inputs.clear();
+	outputs.clear();
+
+	std::istringstream inputStream(line.substr(0, separator));
+	std::istringstream outputStream(line.substr(separator + 1));
+	float value;
+
+	while (inputStream >> value)
+		inputs.push_back(value);
+
+	while (outputStream >> value)
+		outputs.push_back(value);
+
+	//Both parts must have been read entirely
+	return !inputs.empty() && !outputs.empty() && inputStream.eof() && outputStream.eof();
+}
+
+void TextLearningSource::restart()
+{
+	_file.clear();
+	_file.seekg(0);
+	_lineNumber = 0;
+}
+
+bool TextLearningSource::read(LearningVector & inputs, LearningVector & outputs)
+{
+	while (std::getline(_file, _line))
+	{
+		_lineNumber++;
+
+		const std::size_t start = _line.find_first_not_of(" \t\r");
+
+		if (start == std::string::npos || _line[start] == '#') //Empty line or comment
+			continue;
+
+		if (_parser(_line, inputs, outputs))
+			return true;
+
+		WARNING_MSG("Cannot parse line " << _lineNumber << " of file " << _fileName << ", ignoring it");
+	}
+
+	return false;
+}
@@ -0,0 +1,85 @@
+#include "threadpool.hpp"
+
+using namespace ENN;
+
+ThreadPool::ThreadPool(unsigned numberOfThreads)
+ : _task(nullptr), _generation(0), _remainingWorkers(0), _stopping(false)
+{
+	if (numberOfThreads == 0)
+	{
+		WARNING_MSG("A thread pool needs at least one thread, using one");
+		numberOfThreads = 1;
+	}
+	
+	for (unsigned i=1 ; i<numberOfThreads ; i++)
+		_workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	
+	_taskAvailable.notify_all();
+	
+	for (std::thread & worker : _workers)
+		worker.join();
+}
+
+unsigned ThreadPool::getNumberOfThreads() const
+{
+	return _workers.size() + 1;
+}
+
+void ThreadPool::run(std::function<void(unsigned)> const & task)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_task = &task;
+		_remainingWorkers = _workers.size();
+		_generation++;
+	}
+	
+	_taskAvailable.notify_all();
+	
+	//The calling thread takes its share of the work instead of sleeping
+	task(0);
+	
+	std::unique_lock<std::mutex> lock(_mutex);
+	_taskDone.wait(lock, [this]{ return _remainingWorkers == 0; });
+	_task = nullptr;
+}
+
+void ThreadPool::work(unsigned thread)
+{
+	unsigned long lastGeneration = 0;
+	
+	while (true)
+	{
+		std::function<void(unsigned)> const * task;
+		
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_taskAvailable.wait(lock, [&]{ return _stopping || _generation != lastGeneration; });
+			
+			if (_stopping)
+				return;
+			
+			lastGeneration = _generation;
+			task = _task;
+		}
+		
+		(*task)(thread);
+		
+		bool last;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			last = (--_remainingWorkers == 0);
+		}
+		
+		if (last)
+			_taskDone.notify_one();
+	}
+}
@@ -0,0 +1,21 @@
+#include "trainingobserver.hpp"
+
+using namespace ENN;
+
+TrainingStatistics::TrainingStatistics()
+ : cycle(0), error(0.f), validationError(-1.f), numberOfPoints(0), numberOfUpdates(0), duration(0.), pointsPerSecond(0.),
+   forwardTime(0.), backwardTime(0.), updateTime(0.), gradientNorm(0.)
+{
+}
+
+TrainingObserver::~TrainingObserver()
+{
+}
+
+void TrainingObserver::onTrainingBegin()
+{
+}
+
+void TrainingObserver::onTrainingEnd(unsigned, float)
+{
+}